@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "miniaudio.h"
 
@@ -53,6 +54,9 @@ public:
     void playSfx(const char* path);
     void stopSfx();
 
+    // Decode a sfx in the background and keep it around, so playSfx() of it doesn't have to
+    void preloadSfx(const char* path);
+
     // Volume - [0.0, 1.0]
     void setMusicVolume(float volume);
     void setSfxVolume(float volume);
@@ -65,7 +69,8 @@ private:
     ma_sound  m_music{};
     ma_sound  m_sfx{};
 
-    std::string m_current_music;
+    std::string              m_current_music;
+    std::vector<std::string> m_preloaded;  // registered with the resource manager, decoded
 
     bool  m_engine_ready = false;
     bool  m_music_loaded = false;
@@ -0,0 +1,9 @@
+#pragma once
+
+// Benchmarks and frame dumps, they draw on a headless backend so no tty (or audio) is needed.
+
+// `cliboy --bench [WIDTHxHEIGHT]`: cells/sec of the drawing primitives, then frames/sec of every scene
+int run_benchmarks(int argc, char* argv[]);
+
+// `cliboy --dump SCENE [WIDTHxHEIGHT] [--ansi]`: print the first frame of a scene, as text or with colors
+int dump_scene(int argc, char* argv[]);
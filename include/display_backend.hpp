@@ -0,0 +1,250 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#define TB_OPT_ATTR_W 32
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-field-initializers"
+#ifdef _WIN32
+#  include "termbox2_win.h"
+#else
+#  include "termbox2.h"
+#endif
+#pragma GCC diagnostic pop
+
+// Counters of the last present, useful to see how much work a frame really costs
+struct DisplayStats
+{
+    size_t cells_compared = 0;  // cells diffed against the front buffer
+    size_t cells_changed  = 0;  // cells that differed and got sent to the terminal
+    size_t bytes_written  = 0;  // escape sequences and text sent for them
+
+    // These count up since begin()
+    size_t frames_presented = 0;  // frames that got diffed and sent
+    size_t frames_skipped   = 0;  // frames identical to what's on screen, nothing got done for them
+    size_t frames_held      = 0;  // frames put off because the previous one was still being written
+    size_t frames_dropped   = 0;  // frames the game loop didn't render to keep up (FrameGovernor)
+};
+
+// Inclusive range of columns touched on a row, empty when x1 < x0
+struct RowSpan
+{
+    int x0 = INT_MAX;
+    int x1 = -1;
+
+    bool empty() const { return x1 < x0; }
+    bool contains(int x) const { return x >= x0 && x <= x1; }
+    void add(int a, int b)
+    {
+        x0 = std::min(x0, a);
+        x1 = std::max(x1, b);
+    }
+};
+
+// What an empty cell holds
+inline tb_cell blank_cell()
+{
+    tb_cell cell{};
+    cell.ch = ' ';
+    cell.fg = TB_DEFAULT;
+    cell.bg = TB_DEFAULT;
+    return cell;
+}
+
+// Nearest color to `rgb` (0xRRGGBB) the way cells hold it in output `mode` (TB_OUTPUT_*):
+// as is in truecolor, an index of the xterm palette in 256 colors, TB_BLACK..TB_WHITE (maybe TB_BRIGHT) in 16 colors
+uintattr_t quantize_color(uint32_t rgb, int mode);
+
+// What a key did. Only terminals speaking the kitty keyboard protocol tell these apart
+// (see DisplayBackend::setKeyEvents()), with the others every key is a press, auto-repeats included.
+enum class KeyAction
+{
+    Press,
+    Repeat,
+    Release,
+};
+
+// What the key of the TB_EVENT_KEY `ev` did
+KeyAction key_action(const tb_event& ev);
+
+// Cells the codepoint `ch` takes on screen (0, 1 or 2), or -1 if it isn't printable (tb_iswprint()).
+// The BMP is looked up in a table of 2 bits per codepoint built on first use, the rest asks tb_wcwidth().
+int cell_width(uint32_t ch);
+
+// Decode the UTF-8 char at `i`, moving past it, and get how many cells it takes.
+// Truncated and non-printable chars become U+FFFD, like in tb_print().
+uint32_t utf8_next(std::string_view text, size_t& i, int& w);
+
+// What measure_text() found in a UTF-8 string
+struct TextMetrics
+{
+    size_t bytes      = 0;
+    size_t codepoints = 0;
+    int    cells      = 0;  // width on screen, as drawn by TerminalDisplay
+};
+
+// Bytes, codepoints and cells of `text`, in one pass
+TextMetrics measure_text(std::string_view text);
+
+// Where TerminalDisplay draws to.
+// It owns the back buffer TerminalDisplay writes cells into, and present() gets them to the screen (or wherever).
+class DisplayBackend
+{
+public:
+    virtual ~DisplayBackend() = default;
+
+    virtual bool init()        = 0;
+    virtual void shutdown()    = 0;
+    virtual bool ready() const = 0;
+
+    // Current size, it can change between frames
+    virtual int width() const  = 0;
+    virtual int height() const = 0;
+
+    // Back buffer, height() rows of width() cells
+    virtual tb_cell* cells() = 0;
+
+    // Send out the cells in the `dirty` spans that changed since the last present, then reset the spans
+    virtual void present(std::vector<RowSpan>& dirty, DisplayStats& stats) = 0;
+
+    // TB_OUTPUT_* mode the colors of the cells are in, and the one that suits the output best
+    virtual int  outputMode() const          = 0;
+    virtual void setOutputMode(int mode)     = 0;
+    virtual int  preferredOutputMode() const = 0;
+
+    // True if present() held back changes, they go out with the next present() that can send them
+    virtual bool hasHeldChanges() const { return false; }
+
+    // Scroll the rows `top`..`bottom` of the screen down by `n`, blanking the `n` rows at the top,
+    // and update the front buffer to match. It goes out before the next present's cells.
+    // Returns false if the backend can't, the rows then just get diffed and sent again.
+    virtual bool scrollRows(int /*top*/, int /*bottom*/, int /*n*/) { return false; }
+
+    // Ask the terminal to report key repeats and releases (kitty keyboard protocol), or to stop.
+    // Terminals without the protocol ignore it and keep sending plain keys.
+    virtual void setKeyEvents(bool /*enable*/) {}
+
+    // True once the terminal answered that it reports them
+    virtual bool keyEventsReported() const { return false; }
+
+    // Called before termbox reads input. termbox handles a pending resize in there and clears the screen
+    // straight through the tty, so a frame still being written from another thread has to be done by then.
+    // `blocking` means the read may wait, and a resize can come in while it does
+    virtual void beforeInput(bool /*blocking*/) {}
+};
+
+// The real terminal, through termbox2
+class TermboxBackend : public DisplayBackend
+{
+public:
+    ~TermboxBackend() override;
+
+    bool init() override;
+    void shutdown() override;
+    bool ready() const override;
+
+    int width() const override;
+    int height() const override;
+
+    tb_cell* cells() override;
+    void     present(std::vector<RowSpan>& dirty, DisplayStats& stats) override;
+
+    int  outputMode() const override;
+    void setOutputMode(int mode) override;
+    int  preferredOutputMode() const override { return m_preferred_mode; }
+
+    bool hasHeldChanges() const override { return m_has_held; }
+    bool scrollRows(int top, int bottom, int n) override;
+
+    void setKeyEvents(bool enable) override;
+    bool keyEventsReported() const override;
+
+    void beforeInput(bool blocking) override;
+
+private:
+    void writeFrame(const std::string& frame);
+    void writerLoop();
+    void waitWriterIdle();
+    void stopWriter();
+
+    std::string m_out;     // the frame gets encoded here, then handed to termbox in one go
+    std::string m_scroll;  // scrolls to send before the next frame
+    bool        m_key_events = false;
+
+    // Picked from COLORTERM/TERM, then lowered if writing to the tty turns out to be slow.
+    // The window is only touched by whoever writes, and the two threads never write at the same time.
+    std::atomic<int> m_preferred_mode = TB_OUTPUT_TRUECOLOR;
+    size_t           m_window_bytes   = 0;
+    double           m_window_secs    = 0;
+
+    // Threaded output (settings.general.async_output): encoded frames are handed to m_writer.
+    // While it's still writing, newer frames don't get encoded: their dirty spans pile up in m_held
+    // and go out with the next present after it's done, so only the latest state ever gets written.
+    std::thread             m_writer;
+    std::mutex              m_mutex;
+    std::condition_variable m_cv;
+    std::string             m_pending;  // next frame for the writer, empty if none
+    std::string             m_writing;  // the one it's writing
+    bool                    m_busy = false;
+    bool                    m_stop = false;
+    std::vector<RowSpan>    m_held;
+    bool                    m_has_held    = false;
+    int                     m_sent_width  = -1;
+    int                     m_sent_height = -1;
+};
+
+// In-memory cell grid, no tty needed.
+// For benchmarking the rendering on its own and comparing frames.
+class HeadlessBackend : public DisplayBackend
+{
+public:
+    HeadlessBackend(int width, int height) : m_width(width), m_height(height) {}
+
+    bool init() override;
+    void shutdown() override { m_ready = false; }
+    bool ready() const override { return m_ready; }
+
+    int width() const override { return m_width; }
+    int height() const override { return m_height; }
+
+    tb_cell* cells() override { return m_back.data(); }
+    void     present(std::vector<RowSpan>& dirty, DisplayStats& stats) override;
+
+    int  outputMode() const override { return m_output_mode; }
+    void setOutputMode(int mode) override { m_output_mode = mode; }
+    int  preferredOutputMode() const override { return TB_OUTPUT_TRUECOLOR; }
+
+    bool scrollRows(int top, int bottom, int n) override;
+
+    // Act as a terminal that reports key releases or not, whatever gets asked with setKeyEvents() (for replays)
+    bool keyEventsReported() const override { return m_key_events_reported; }
+    void reportKeyEvents(bool reported) { m_key_events_reported = reported; }
+
+    // Same as a terminal resize, both buffers get blanked even if the size stays the same
+    void resize(int width, int height);
+
+    // The last presented frame, as plain text or with the colors as ANSI escapes
+    std::string dumpText() const;
+    std::string dumpAnsi() const;
+
+private:
+    int  m_width, m_height;
+    int  m_output_mode         = TB_OUTPUT_TRUECOLOR;
+    bool m_ready               = false;
+    bool m_key_events_reported = false;
+
+    std::vector<tb_cell> m_back;
+    std::vector<tb_cell> m_front;  // what got presented
+    std::string          m_out;     // encoded like for a terminal, only to count the bytes
+    std::string          m_scroll;  // scrolls to count with the next frame
+};
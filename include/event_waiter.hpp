@@ -0,0 +1,35 @@
+#pragma once
+
+#include "display_backend.hpp"
+#include "frame_governor.hpp"
+
+// Waits for the next terminal event (key, resize) or an absolute deadline, whichever comes first.
+// On Linux it's an epoll over the tty, termbox's SIGWINCH pipe (tb_get_fds()) and a timerfd armed on
+// the deadline itself, so the wait ends when it's due down to the µs: no rounding to ms, and input
+// coming in doesn't restart the timeout like with tb_peek_event(), ticks stay on time whatever the input does.
+// Elsewhere, or if setting that up fails, it falls back to tb_peek_event().
+// How late the timer wakes up past the deadline goes to the profiler (ProfilePhase::TimerLate).
+class EventWaiter
+{
+public:
+    EventWaiter() = default;
+    ~EventWaiter();
+
+    EventWaiter(const EventWaiter&)            = delete;
+    EventWaiter& operator=(const EventWaiter&) = delete;
+
+    // Set up the epoll, once termbox is initialized. False if it couldn't (it then falls back)
+    bool init();
+
+    // Wait for an event until `deadline` (GameClock::time_point::max() to block).
+    // True with the event in `ev`, false once the deadline came or the wait failed.
+    bool wait(tb_event& ev, GameClock::time_point deadline);
+
+private:
+    // Close the epoll and the timer, if open, leaving the fallback
+    void closeFds();
+
+    int  m_epoll_fd  = -1;
+    int  m_timer_fd  = -1;
+    bool m_timer_set = false;  // whether m_timer_fd is armed
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+
+// Scratch memory for the short-lived containers built while handling a key or drawing a frame
+// (the lines of a 2048 move, the cells a new tile can go in, ...), give them resource().
+// Allocating just bumps a pointer into a fixed buffer, and everything gets taken back at once by reset()
+// at the end of each Scene::render_all(), so nothing allocated from it may be kept past that.
+// Only if a frame needs more than the buffer it falls back to the heap.
+class FrameArena
+{
+public:
+    FrameArena() : m_resource(m_buffer.data(), m_buffer.size(), std::pmr::new_delete_resource()) {}
+
+    FrameArena(const FrameArena&)            = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    std::pmr::memory_resource* resource() { return &m_resource; }
+    void                       reset() { m_resource.release(); }
+
+private:
+    alignas(std::max_align_t) std::array<std::byte, 64 * 1024> m_buffer;
+    std::pmr::monotonic_buffer_resource m_resource;
+};
+
+extern FrameArena frame_arena;
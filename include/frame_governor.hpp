@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+// The clock the game loop and the scenes' updates run on, monotonic with 64-bit nanoseconds
+using GameClock = std::chrono::steady_clock;
+
+// Longest a frame stays on screen before an awaiting change gets rendered: renders happen at most once per interval
+inline constexpr std::chrono::milliseconds DISPLAY_INTERVAL{ 16 };  // ~60 Hz
+
+// What the game loop did since the last FrameGovernor::reset(), to tell how busy it is
+struct LoopStats
+{
+    size_t ticks         = 0;  // update() calls
+    size_t renders       = 0;
+    size_t input_wakeups = 0;  // waits for input that ended with an event
+    size_t timer_wakeups = 0;  // ... that timed out, for a tick, a render or a deadline
+
+    GameClock::time_point since;
+};
+
+// Schedules the game loop: fixed-timestep ticks for the scene, and renders.
+// Time that passes is piled up and paid out in ticks of Scene::frame_ms(), so the game runs at the same
+// speed however often input comes in or however long renders take. When it falls behind, a frame runs
+// up to Scene::max_frame_skip() extra ticks before rendering (those frames count as dropped),
+// and any time still owed after that is let go, so the game slows down instead of spiraling.
+// Renders only happen when something changed (a tick, input, a resize), and at most once per DISPLAY_INTERVAL.
+// With no ticks, nothing to render and no deadline, the loop blocks on input: an idle game doesn't wake up at all.
+class FrameGovernor
+{
+public:
+    // Start over at `now`, when switching scenes. The first frame always gets rendered.
+    void reset(GameClock::time_point now);
+
+    // Ticks of `tick` due at `now`, to run before the next render (none if `tick` isn't positive)
+    int ticksDue(GameClock::time_point now, GameClock::duration tick, int max_skip);
+
+    // Something changed that the screen has to show
+    void invalidate() { m_dirty = true; }
+
+    // Whether to render at `now`
+    bool shouldRender(GameClock::time_point now) const;
+
+    // A render started at `start`
+    void rendered(GameClock::time_point start);
+
+    // The wait for input ended, with an event if `input`
+    void wokeUp(bool input) { ++(input ? m_stats.input_wakeups : m_stats.timer_wakeups); }
+
+    const LoopStats& stats() const { return m_stats; }
+
+    // Until when the loop may wait for input before there's a tick or a render to do,
+    // or `wake` comes (the scene waiting on something else), GameClock::time_point::max() to block.
+    // It's where the next tick falls on the fixed timestep, not a timeout from `now`,
+    // so waking up for input in between doesn't shift it.
+    GameClock::time_point nextWake(GameClock::time_point now, GameClock::duration tick,
+                                   GameClock::time_point wake = GameClock::time_point::max()) const;
+
+private:
+    GameClock::time_point m_last;            // when ticksDue() last took the time
+    bool                  m_ticking = true;  // whether the time since then counts towards ticks
+    GameClock::duration   m_owed{};          // time not paid out in ticks yet
+    GameClock::time_point m_next_render;     // renders can't happen before this
+    bool                  m_dirty = true;
+    LoopStats             m_stats;
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "frame_governor.hpp"
+
+// The parts of a frame the profiler times, and the game loop's timer accuracy
+enum class ProfilePhase
+{
+    Input,        // draining the events of a batch, Scene::handle_key() left out
+    HandleInput,  // Scene::handle_key() calls of the batch
+    Render,       // Scene::render()
+    Footer,       // Scene::render_footer()
+    Present,      // TerminalDisplay::endFrame(): diffing the cells and writing them out
+    TimerLate,    // not a phase: how late the game loop woke up past the deadline it waited for (EventWaiter)
+    COUNT,
+};
+
+// Where a frame's time goes, per phase. Recording a sample is two stores into fixed arrays:
+// the last RING_SIZE samples, that the overlay (F3) takes its rolling p50/p99/max from,
+// and a histogram of every sample since start, written to a file by dump() on exit.
+// It's always on, the overlay only shows it.
+class FrameProfiler
+{
+public:
+    // Samples the overlay takes its numbers from, ~4s worth at 60 fps
+    static constexpr size_t RING_SIZE = 256;
+
+    // Histogram buckets: 1µs wide below 4µs, then 4 per power of 2, the last one takes anything above ~1.8s
+    static constexpr size_t BUCKETS = 80;
+
+    // Count `d` spent in `phase`
+    void record(ProfilePhase phase, GameClock::duration d);
+
+    // Count the time from `start` until now in `phase`, and return now, for timing the next phase from there
+    GameClock::time_point lap(ProfilePhase phase, GameClock::time_point start)
+    {
+        const GameClock::time_point now = GameClock::now();
+        record(phase, now - start);
+        return now;
+    }
+
+    void toggleOverlay()
+    {
+        m_overlay = !m_overlay;
+        m_shown |= m_overlay;
+    }
+    bool overlay() const { return m_overlay; }
+
+    // Draw the overlay in the top right corner of the frame being built, if it's on
+    void draw();
+
+    // Write the histograms to `path`, if the overlay got turned on at some point (nobody asked for them otherwise).
+    // Returns false if the file couldn't be written.
+    bool dump(const std::string& path) const;
+
+private:
+    struct Samples
+    {
+        std::array<uint32_t, RING_SIZE> ring{};  // µs
+        std::array<uint64_t, BUCKETS>   histogram{};
+        uint64_t                        count = 0;
+        uint64_t                        total = 0;  // µs
+        uint32_t                        max   = 0;  // µs, of all samples
+    };
+
+    std::array<Samples, static_cast<size_t>(ProfilePhase::COUNT)> m_phases;
+
+    bool m_overlay = false;
+    bool m_shown   = false;
+};
+
+extern FrameProfiler profiler;
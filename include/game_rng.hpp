@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <string_view>
+
+// Where the games get their randomness from (pieces, tiles, food, words).
+// One seed for the whole session, random unless given (`--seed`, or a replay's), and each game draws from
+// its own stream derived from it: the same seed deals the same pieces and words again whatever the other games did.
+class GameRng
+{
+public:
+    GameRng() : m_seed(static_cast<uint64_t>(std::random_device{}()) << 32 | std::random_device{}()) {}
+
+    // Set it before the scenes get created, they take their engines once
+    void     seed(uint64_t seed) { m_seed = seed; }
+    uint64_t seed() const { return m_seed; }
+
+    // An engine for the stream `name`, the same sequence every time for the same seed and name
+    std::mt19937 engine(std::string_view name) const
+    {
+        // FNV-1a
+        uint64_t hash = 14695981039346656037ull;
+        for (const char c : name)
+            hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+
+        std::seed_seq seq{ static_cast<uint32_t>(m_seed), static_cast<uint32_t>(m_seed >> 32),
+                           static_cast<uint32_t>(hash), static_cast<uint32_t>(hash >> 32) };
+        return std::mt19937(seq);
+    }
+
+private:
+    uint64_t m_seed;
+};
+
+extern GameRng game_rng;
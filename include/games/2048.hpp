@@ -2,7 +2,10 @@
 
 #include <array>
 #include <cstdint>
+#include <random>
+#include <string>
 
+#include "game_rng.hpp"
 #include "scenes.hpp"
 #include "terminal_display.hpp"
 
@@ -31,14 +34,19 @@ public:
           m_grid_y(0),
           m_cell_w(0),
           m_cell_h(0),
-          m_cell_padding(0) {};
+          m_cell_padding(0)
+    {
+        add_layer(m_chrome);
+    }
     ~Game2048() override = default;
 
     void        render() override;
     SceneResult handle_input(uint32_t key) override;
+    bool        coalesce_repeats() const override { return true; }
 
 protected:
     Result<> on_begin() override;
+    void     on_resize(int width, int height) override;
 
 private:
     // Game state
@@ -55,14 +63,19 @@ private:
     int m_cell_h;
     int m_cell_padding;
 
+    // Grid border, redrawn only when the layout changes
+    DisplayLayer m_chrome;
+
+    std::mt19937 m_rng{ game_rng.engine("2048") };
+
     // Helper functions
-    void        init_game();
-    void        add_new_tile();
-    bool        move(Direction d);
-    bool        is_move_possible() const;
-    bool        check_win() const;
-    uintattr_t  get_color_for_value(int value) const;
-    std::string format_number(int value) const;
+    void             init_game();
+    void             add_new_tile();
+    bool             move(Direction d);
+    bool             is_move_possible() const;
+    bool             check_win() const;
+    uintattr_t       get_color_for_value(int value) const;
+    std::pmr::string format_number(int value) const;
 
     // Drawing functions
     void draw_grid();
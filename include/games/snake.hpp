@@ -3,6 +3,7 @@
 #include <deque>
 #include <random>
 
+#include "game_rng.hpp"
 #include "scenes.hpp"
 
 enum class SnakeDir
@@ -16,12 +17,23 @@ enum class SnakeDir
 class SnakeGame : public Scene
 {
 public:
+    SnakeGame() { add_layer(m_chrome); }
+
     Result<>    on_begin() override;
     void        render() override;
     SceneResult handle_input(uint32_t key) override;
 
-    // Ticked frame loop, speed increases with score
-    int frame_ms() override { return m_speed_ms; }
+    // One move per tick, speed increases with score
+    int  frame_ms() const override { return m_speed_ms; }
+    void update(GameClock::duration dt) override;
+    int  max_frame_skip() const override { return 4; }
+    bool wants_ticks() const override { return !m_dead && !m_paused; }
+    bool coalesce_repeats() const override { return true; }
+
+    std::vector<const char*> sounds() const override { return { SnakeSounds::FOOD }; }
+
+protected:
+    void on_resize(int width, int height) override;
 
 private:
     // board cell coordinate
@@ -32,7 +44,6 @@ private:
     };
 
     void init_game();
-    void update();
     void spawn_food();
     void draw_border();
     void draw_hud();
@@ -45,12 +56,16 @@ private:
     int m_board_w{};  // total width  including border
     int m_board_h{};  // total height including border
 
+    // Board border, redrawn only when the layout changes
+    DisplayLayer m_chrome;
+
     // game state
     std::deque<Point> m_snake;
     Point             m_food{};
 
-    SnakeDir m_dir      = SnakeDir::Right;
-    SnakeDir m_next_dir = SnakeDir::Right;
+    // Turns pressed since the last move, taken one per tick so quick presses (up then left) all land
+    SnakeDir             m_dir = SnakeDir::Right;
+    std::deque<SnakeDir> m_turns;
 
     bool m_dead   = false;
     bool m_paused = false;
@@ -58,5 +73,5 @@ private:
     int m_score    = 0;
     int m_speed_ms = 130;  // ms per tick; decreases every 5 pts
 
-    std::mt19937 m_rng{ std::random_device{}() };
+    std::mt19937 m_rng{ game_rng.engine("snake") };
 };
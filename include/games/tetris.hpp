@@ -2,8 +2,10 @@
 
 #include <array>
 #include <cstdint>
+#include <random>
 #include <vector>
 
+#include "game_rng.hpp"
 #include "scenes.hpp"
 #include "terminal_display.hpp"
 
@@ -37,21 +39,30 @@ public:
           m_level(0),
           m_game_over(false),
           m_paused(false),
-          m_fall_timer(0),
-          m_last_update(0),
           m_grid_x(0),
           m_grid_y(0),
           m_cell_size(1),
           m_grid_w(0),
-          m_grid_h(0) {};
+          m_grid_h(0)
+    {
+        add_layer(m_chrome);
+    }
     ~TetrisGame() override = default;
 
     void        render() override;
     SceneResult handle_input(uint32_t key) override;
-    int         frame_ms() override { return 16; }  // ~60 FPS for smooth input
+    SceneResult handle_key(uint32_t key, KeyAction action) override;
+    int         frame_ms() const override { return 16; }  // ~60 FPS for smooth input
+    void        update(GameClock::duration dt) override;
+    int         max_frame_skip() const override { return 4; }
+    bool        wants_ticks() const override { return !m_game_over && !m_paused; }
+    bool        coalesce_repeats() const override { return true; }
+
+    std::vector<const char*> sounds() const override { return { TetrisSounds::LINE_CLEAR }; }
 
 protected:
     Result<> on_begin() override;
+    void     on_resize(int width, int height) override;
 
 private:
     // Game state
@@ -63,8 +74,18 @@ private:
     int                                m_level;
     bool                               m_game_over;
     bool                               m_paused;
-    uint32_t                           m_fall_timer;
-    uint32_t                           m_last_update;
+    GameClock::duration                m_fall_elapsed{};  // since the piece last fell a row
+
+    // Rows cleared since the last render, in order: render() scrolls the grid on screen for each
+    std::vector<int> m_cleared_rows;
+
+    // Move key held down, repeated by update() when the terminal reports releases (0 if none)
+    uint32_t            m_held_key = 0;
+    GameClock::duration m_repeat_in{};  // until its next repeat
+
+    // 7-bag randomizer: every piece once, shuffled, before the next bag
+    std::mt19937               m_rng{ game_rng.engine("tetris") };
+    std::vector<TetrominoType> m_bag;
 
     // Position and dimensions
     int m_grid_x;
@@ -73,6 +94,9 @@ private:
     int m_grid_w;
     int m_grid_h;
 
+    // Borders, NEXT box and HUD labels, redrawn only when the layout changes
+    DisplayLayer m_chrome;
+
     // Helper functions
     void           init_game();
     Tetromino      spawn_piece(TetrominoType type);
@@ -93,7 +117,9 @@ private:
     // Drawing functions
     void draw_grid();
     void draw_current_piece();
+    void draw_next_box();
     void draw_next_piece();
+    void draw_hud_labels();
     void draw_hud();
     void draw_game_over();
     void draw_paused();
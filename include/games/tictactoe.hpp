@@ -24,22 +24,48 @@ public:
     void        render() override;
     SceneResult handle_input(uint32_t key) override;
 
+protected:
+    void on_resize(int width, int height) override;
+
 private:
+    // What takes the screen once the game is over
+    enum class EndScreen
+    {
+        None,
+        Winner,
+        BoardFull,
+    };
+
     char   m_board[3][3]    = { { ' ', ' ', ' ' }, { ' ', ' ', ' ' }, { ' ', ' ', ' ' } };
-    bool   m_choose_pos     = false;
-    Player m_current_player = Player::X;
+    Player m_current_player = Player::X;  // who places next
     int    m_old_pos_x{}, m_cursor_x{};
     int    m_old_pos_y{}, m_cursor_y{};
     int    m_moves = 0;
 
+    // End of game sequence: the winning line gets struck through, then the end screen shows.
+    // The line's ends are in half cells from the board's top left, so it follows the layout.
+    int       m_strike_x0{}, m_strike_y0{}, m_strike_x1{}, m_strike_y1{};
+    int       m_strike_step = 0;  // how much of the strike is drawn, out of STRIKE_STEPS
+    Player    m_winner      = Player::None;
+    EndScreen m_end_screen  = EndScreen::None;
+
+    // Board geometry, set by on_resize()
+    int m_board_size{}, m_cell_size{};
+    int m_board_x{}, m_board_y{};
+
     void draw_piece(int row, int col, char piece);
     void draw_game_screen();
+    void draw_strike();
     void draw_winner(Player winner);
+    void draw_board_full();
 
-    bool   is_board_full();
-    void   animate_line(int x0, int y0, int x1, int y1);
-    Player check_winner();
-    void   reset_game();
+    bool      is_board_full();
+    void      place_piece();
+    void      set_strike(int x0, int y0, int x1, int y1);
+    Player    check_winner();
+    void      reset_game();
+    SceneTask show_win(Player winner);
+    SceneTask show_board_full();
 
     template <typename Func>
     auto iterate_board(Func&& fun)
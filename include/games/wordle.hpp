@@ -1,7 +1,9 @@
 #pragma once
 
+#include <random>
 #include <vector>
 
+#include "game_rng.hpp"
 #include "scenes.hpp"
 
 enum class TileState
@@ -24,20 +26,31 @@ using WordleStates = std::array<std::array<Tile, 5>, 6>;
 class WordleGame : public Scene
 {
 public:
+    Result<>    on_load() override;
+    bool        loads_in_background() const override { return true; }
     Result<>    on_begin() override;
     void        render() override;
     SceneResult handle_input(uint32_t key) override;
 
 private:
+    // What takes the screen once the game is over, after the final grid
+    enum class EndScreen
+    {
+        None,
+        Won,
+        Lost,
+    };
+
     std::string              m_buf;
     std::string              m_guess;
     std::string              m_invalid_word;
     std::vector<std::string> m_words_list;
-    bool                     m_is_selected{};
     bool                     m_is_correct{};
     bool                     m_is_invalid{};
     WordleStates             m_grid{};
     int                      m_row{};
+    EndScreen                m_end_screen = EndScreen::None;
+    std::mt19937             m_rng{ game_rng.engine("wordle") };
 
     static uintattr_t bg_for(TileState s);
     static uintattr_t fg_for(TileState s);
@@ -50,4 +63,6 @@ private:
     void        draw_not_valid(const std::string& word);
     void        draw_end_game(bool won);
     void        reset_game();
+    void        submit_guess();
+    SceneTask   show_end_game(bool won);
 };
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "display_backend.hpp"
+
+// Records what drives a session (`cliboy --record FILE`), for replay_session() to play it again.
+// Nothing but input and ticks feeds the scenes, so that's all it takes: the seed of game_rng and the terminal size,
+// then in order every key the scenes got, resize and sequence resumed (Scene::resume_sequence()),
+// each with how many update() ticks ran before it. Varints, a few bytes per event, flushed right away
+// so a session that crashed still has everything that led to it.
+class InputRecorder
+{
+public:
+    InputRecorder() = default;
+    ~InputRecorder() { close(); }
+
+    InputRecorder(const InputRecorder&)            = delete;
+    InputRecorder& operator=(const InputRecorder&) = delete;
+
+    // Start recording to `path`, false if it can't be created
+    bool open(const std::string& path, uint64_t seed, int width, int height);
+
+    // Mark the end and close the file, the recording is complete
+    void close();
+
+    // An update() tick ran
+    void tick() { ++m_ticks; }
+
+    // What went to the scene: a key given to Scene::handle_key(), a resize it relaid out for,
+    // its sequence resumed, ESC while it was still loading (the game loop went back without starting it)
+    void key(uint32_t key, KeyAction action);
+    void resize(int width, int height);
+    void resumed();
+    void loadCancelled();
+
+private:
+    void entry(uint8_t kind);
+    void varint(uint64_t v);
+
+    FILE*    m_file      = nullptr;
+    uint64_t m_ticks     = 0;
+    uint64_t m_last_tick = 0;  // m_ticks as of the last entry, entries store the difference
+
+    // Whether the terminal reports key releases, Tetris handles held keys differently if it does
+    bool m_key_events_reported = false;
+};
+
+// `cliboy --replay FILE [--dump]`: play a recording back on a headless display, as fast as it goes,
+// rendering a frame for every tick and event, and print the frames/sec. With --dump, print the last frame too.
+int replay_session(int argc, char* argv[]);
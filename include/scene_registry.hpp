@@ -0,0 +1,38 @@
+#pragma once
+
+#include "games/2048.hpp"
+#include "games/snake.hpp"
+#include "games/tetris.hpp"
+#include "games/tictactoe.hpp"
+#include "games/wordle.hpp"
+#include "scenes.hpp"
+#include "scenes/credits.hpp"
+#include "scenes/games_menu.hpp"
+#include "scenes/main_menu.hpp"
+#include "scenes/settings.hpp"
+
+// One of every scene, for a session: the game loop's, or a replay's (see replay.hpp)
+class SceneRegistry
+{
+public:
+    SceneRegistry() = default;
+    ~SceneRegistry();
+
+    SceneRegistry(const SceneRegistry&)            = delete;
+    SceneRegistry& operator=(const SceneRegistry&) = delete;
+
+    // The scene behind `id`, nullptr for Exit
+    Scene* get(const SceneResult& id);
+
+private:
+    MainMenuScene  m_main_menu;
+    GamesMenuScene m_games_menu;
+    CreditsScene   m_credits;
+    SettingsScene  m_settings_menu;
+
+    TetrisGame m_tetris;
+    TTTGame    m_ttt;
+    WordleGame m_wordle;
+    SnakeGame  m_snake;
+    Game2048   m_2048;
+};
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+#include "frame_governor.hpp"
+
+// A sequence a scene plays out over several frames (an animation, an end-game screen), written as a coroutine.
+// The coroutine only changes the scene's state, render() draws it as usual:
+//
+//     SceneTask TTTGame::show_win()
+//     {
+//         m_end_screen = EndScreen::Winner;
+//         co_await display_for(2s);  // the frame ends here, the game loop comes back in 2s
+//         reset_game();
+//     }
+//
+// It runs right away up to its first co_await, then the game loop resumes it (Scene::resume_sequence())
+// once the wait is over, without ever blocking: input, resizes and ESC keep working meanwhile.
+class SceneTask
+{
+public:
+    struct promise_type
+    {
+        GameClock::time_point wake_at = GameClock::time_point::max();
+
+        SceneTask           get_return_object() { return SceneTask(handle::from_promise(*this)); }
+        std::suspend_never  initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void                return_void() {}
+        void                unhandled_exception() { std::terminate(); }
+    };
+
+    using handle = std::coroutine_handle<promise_type>;
+
+    SceneTask() = default;
+    SceneTask(SceneTask&& other) noexcept : m_handle(std::exchange(other.m_handle, {})) {}
+    SceneTask& operator=(SceneTask&& other) noexcept
+    {
+        if (this != &other)
+        {
+            destroy();
+            m_handle = std::exchange(other.m_handle, {});
+        }
+        return *this;
+    }
+    SceneTask(const SceneTask&)            = delete;
+    SceneTask& operator=(const SceneTask&) = delete;
+    ~SceneTask() { destroy(); }
+
+    // True until the coroutine returns
+    bool running() const { return m_handle && !m_handle.done(); }
+
+    // When it wants to be resumed, GameClock::time_point::max() if it doesn't
+    GameClock::time_point wakeAt() const
+    {
+        return running() ? m_handle.promise().wake_at : GameClock::time_point::max();
+    }
+
+    // Resume it if its wait is over by `now`, true if it did
+    bool resume(GameClock::time_point now)
+    {
+        if (!running() || now < m_handle.promise().wake_at)
+            return false;
+
+        m_handle.promise().wake_at = GameClock::time_point::max();
+        m_handle.resume();
+        return true;
+    }
+
+private:
+    explicit SceneTask(handle h) : m_handle(h) {}
+
+    void destroy()
+    {
+        if (m_handle)
+            m_handle.destroy();
+        m_handle = {};
+    }
+
+    handle m_handle;
+};
+
+// What display_for() returns, co_await it in a SceneTask
+struct DisplayFor
+{
+    GameClock::duration duration;
+
+    bool await_ready() const noexcept { return duration <= GameClock::duration::zero(); }
+    void await_suspend(SceneTask::handle h) const noexcept { h.promise().wake_at = GameClock::now() + duration; }
+    void await_resume() const noexcept {}
+};
+
+// Keep what's on screen for `d`, then carry on with the sequence
+template <class Rep, class Period>
+DisplayFor display_for(std::chrono::duration<Rep, Period> d)
+{
+    return DisplayFor{ std::chrono::duration_cast<GameClock::duration>(d) };
+}
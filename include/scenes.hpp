@@ -1,9 +1,16 @@
 #pragma once
 
 #include <cstdint>
+#include <future>
+#include <optional>
 #include <variant>
+#include <vector>
 
 #include "audio_player.hpp"
+#include "frame_arena.hpp"
+#include "frame_governor.hpp"
+#include "frame_profiler.hpp"
+#include "scene_task.hpp"
 #include "settings.hpp"
 #include "terminal_display.hpp"
 #include "util.hpp"
@@ -34,17 +41,49 @@ using SceneResult = std::variant<Scenes, ScenesGame>;
 class Scene
 {
 public:
-    virtual ~Scene()                               = default;
+    // The display keeps pointers to the scene's layers, they mustn't outlive it
+    virtual ~Scene() { display.removeLayers(m_layers); }
+
+    // render() only draws: when it runs isn't up to the scene (several keys can come in between two frames,
+    // a replay renders after every one), so the game only changes in handle_input(), update() and its sequence
     virtual void        render()                   = 0;
     virtual SceneResult handle_input(uint32_t key) = 0;
     virtual void        end(SceneResult /*next_scene*/) {playback.stopMusic();}
-    virtual int         frame_ms()
+    virtual int         frame_ms() const
     {
-        // If -1, then the tb_peek_event will be blocking
-        // else it run every ms
+        // Length of the update() tick in ms.
+        // If -1, the scene has no ticks and only redraws on input
         return -1;
     }
 
+    // Every key event goes through here. Releases only come when the terminal reports them
+    // (TerminalDisplay::keyEventsReported()), scenes that don't care about them get a key of 0 instead.
+    virtual SceneResult handle_key(uint32_t key, KeyAction action)
+    {
+        return handle_input(action == KeyAction::Release ? 0 : key);
+    }
+
+    // Whether the same key coming in again and again faster than the frames (a held key, the terminal
+    // auto-repeating it while the game loop was busy) should count once per frame instead of once each.
+    // Leave it off for scenes where the keys are text.
+    virtual bool coalesce_repeats() const { return false; }
+
+    // Advance the game by one fixed tick of `dt` (frame_ms()). The game loop calls it at that rate
+    // whatever the input does, keys pressed in between are already handled, so they only take effect here.
+    virtual void update(GameClock::duration /*dt*/) {}
+
+    // Whether update() has anything to do right now. When it doesn't (paused, game over) the game loop
+    // stops ticking it and blocks on input until deadline(), so an idle scene costs no CPU.
+    virtual bool wants_ticks() const { return frame_ms() > 0; }
+
+    // Next time the scene has to wake up whatever the input does, GameClock::time_point::max() if never.
+    // By default when the sequence it's playing is done waiting (play()).
+    virtual GameClock::time_point deadline() const { return sequence_wakeup(); }
+
+    // How many extra ticks the game loop may run in a frame to catch up when rendering
+    // takes longer than frame_ms(), the frames they'd have been rendered in get dropped
+    virtual int max_frame_skip() const { return 0; }
+
     virtual void render_footer()
     {
         if (m_footer_text.empty())
@@ -55,39 +94,167 @@ public:
         display.display();
     }
 
+    // Sound effects the scene plays (under assets/audios), preload() gets them decoded ahead
+    // so the first time they play doesn't stall a frame
+    virtual std::vector<const char*> sounds() const { return {}; }
+
+    // The scene the player is about to pick, if the scene can tell (a highlighted menu entry).
+    // The game loop starts loading it right away.
+    virtual std::optional<SceneResult> next_scene_hint() const { return std::nullopt; }
+
+    // Start loading the scene in the background: on_load() on a worker thread, and its sounds().
+    // Scenes without loads_in_background() get on_load() run on the spot instead, no thread for nothing.
+    // Does nothing if it's loading or loaded already.
+    void preload()
+    {
+        if (m_loaded || m_load.valid())
+            return;
+
+        for (const char* sound : sounds())
+            playback.preloadSfx(sound);
+
+        if (!loads_in_background())
+        {
+            std::promise<Result<>> loaded;
+            loaded.set_value(on_load());
+            m_load = loaded.get_future();
+            return;
+        }
+        m_load = std::async(std::launch::async, [this] { return on_load(); });
+    }
+
+    // True while preload() isn't done, begin() would wait for it
+    bool loading() const { return m_load.valid() && m_load.wait_for(0s) != std::future_status::ready; }
+
+    // Block until preload() is done, if it got started. on_load() writes to the derived scene's members,
+    // so whoever owns the scene has to call it before destroying it: ~Scene() runs after they're gone
+    void wait_loaded() const
+    {
+        if (m_load.valid())
+            m_load.wait();
+    }
+
+    // Same, for `timeout` at most. True if it's done
+    bool wait_loaded(GameClock::duration timeout) const
+    {
+        return !m_load.valid() || m_load.wait_for(timeout) == std::future_status::ready;
+    }
+
+    // Get the scene going, the first time only: finish loading it (see preload()), then on_begin()
     Result<> begin()
     {
         if (m_has_begun)
             return Ok();
 
+        preload();
+        Result<> r = m_load.get();
+        if (!r.ok())
+            return r;
+
+        m_loaded    = true;
         m_has_begun = true;
+        update_layout();
         return on_begin();
     }
 
+    // Call on_resize() if the display got resized since the last layout, the geometry is cached until then
+    void update_layout()
+    {
+        const int width  = display.getWidth();
+        const int height = display.getHeight();
+        if (width == m_layout_width && height == m_layout_height)
+            return;
+
+        m_layout_width  = width;
+        m_layout_height = height;
+        for (DisplayLayer* layer : m_layers)
+            layer->invalidate();
+
+        on_resize(width, height);
+    }
+
     void render_all()
     {
+        // Everything drawn below, including the display() calls
+        // done by the scenes, ends up in a single present
+        display.beginFrame();
+
+        // Coming back from another scene, settings (colors, utf8) might have changed since
+        if (display.setLayers(m_layers))
+            for (DisplayLayer* layer : m_layers)
+                layer->invalidate();
+
         display.clearDisplay();
         display.resetFont();
+        update_layout();
 
+        GameClock::time_point t = GameClock::now();
         render();  // derived class implements this
+        t = profiler.lap(ProfilePhase::Render, t);
 
         render_footer();
+        t = profiler.lap(ProfilePhase::Footer, t);
 
-        display.display();
+        // On top of everything, it shows the previous frames' present, this one's isn't done yet
+        profiler.draw();
+
+        display.endFrame();
+        profiler.lap(ProfilePhase::Present, t);
+
+        // Whatever the input handling and this frame built in there is garbage by now
+        frame_arena.reset();
     }
 
     bool has_begun() const { return m_has_begun; }
 
+    // Resume the sequence the scene is playing (play()) if its wait is over by `now`,
+    // true if it did and the screen needs redrawing. The game loop calls it every frame.
+    bool resume_sequence(GameClock::time_point now) { return m_sequence.resume(now); }
+
+    // When the sequence wants resuming, GameClock::time_point::max() if none is playing
+    GameClock::time_point sequence_wakeup() const { return m_sequence.wakeAt(); }
+
 protected:
+    // Read what the scene needs from disk (word lists and such). It runs on a worker thread (see preload()),
+    // so it must not touch the display or anything outside the scene, that's for on_begin().
+    virtual Result<> on_load() { return Ok(); }
+
+    // Whether on_load() does enough to be worth a worker thread, true for the scenes that read from disk
+    virtual bool loads_in_background() const { return false; }
+
     virtual Result<> on_begin() { return Ok(); }
-    void             set_footer(std::string text, int padding = 3)
+
+    // Recompute the scene's geometry for a `width`x`height` display.
+    // Called before on_begin() and then only when the size changes.
+    virtual void on_resize(int /*width*/, int /*height*/) {}
+
+    void set_footer(std::string text, int padding = 3)
     {
         m_footer_text    = std::move(text);
         m_footer_padding = padding;
     }
 
+    // Register a layer to be composited under the scene while it's active
+    void add_layer(DisplayLayer& layer) { m_layers.push_back(&layer); }
+
+    // Start playing `sequence` (see SceneTask), dropping the one playing if any
+    void play(SceneTask sequence) { m_sequence = std::move(sequence); }
+    bool playing() const { return m_sequence.running(); }
+
+    // Drop the sequence playing, if any. Not from inside it, that would destroy the coroutine running it
+    void stop() { m_sequence = SceneTask{}; }
+
 private:
     bool        m_has_begun      = false;
     int         m_footer_padding = 3;
+    int         m_layout_width   = -1;
+    int         m_layout_height  = -1;
     std::string m_footer_text;
+
+    std::vector<DisplayLayer*> m_layers;
+    SceneTask                  m_sequence;
+
+    // Background load started by preload(), m_loaded once begin() got its result
+    std::future<Result<>> m_load;
+    bool                  m_loaded = false;
 };
@@ -17,6 +17,9 @@ public:
     void        end(SceneResult next_scene) override;
     SceneResult handle_input(uint32_t key) override;
 
+    // Whichever game is highlighted gets loaded while the player makes up their mind
+    std::optional<SceneResult> next_scene_hint() const override { return static_cast<ScenesGame>(m_selected_game); }
+
 private:
     int                  m_selected_game = 0;
     static constexpr int GAME_COUNT      = static_cast<int>(ScenesGame::COUNT);
@@ -3,12 +3,26 @@
 #include <cstdint>
 #include <string>
 
+// How many colors get sent to the terminal
+enum class ColorMode
+{
+    Auto,  // from COLORTERM/TERM, lowered if the output is slow
+    TrueColor,
+    Colors256,
+    Colors16,
+};
+
 struct Settings
 {
     struct general_settings_t
     {
-        std::string assets_path = "./assets";
-        bool        utf8        = true;
+        std::string assets_path    = "./assets";
+        bool        utf8           = true;
+        bool        compact_output = false;  // fewer bytes per frame (REP/ECH, relative moves), for slow links
+        bool        async_output   = false;  // write frames from a thread, dropping stale ones if the tty lags
+        bool        key_events     = false;  // key releases (kitty keyboard protocol), held keys skip the repeat delay
+        ColorMode   color_mode     = ColorMode::Auto;
+        std::string profile_path   = "./cliboy-profile.txt";  // frame time histograms, written on exit if F3 was used
     } general;
 
     struct colors_t
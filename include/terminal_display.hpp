@@ -1,25 +1,18 @@
 #ifndef _TERMINAL_DISPLAY_HPP_
 #define _TERMINAL_DISPLAY_HPP_
 
+#include <array>
 #include <cstdint>
 #include <format>
+#include <iterator>
 #include <memory>
 #include <optional>
+#include <string>
 #include <string_view>
 #include <vector>
 
+#include "display_backend.hpp"
 #include "libfiglet/libfiglet.hpp"
-
-#define TB_OPT_ATTR_W 32
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wmissing-field-initializers"
-#ifdef _WIN32
-#  include "termbox2_win.h"
-#else
-#  include "termbox2.h"
-#endif
-#pragma GCC diagnostic pop
-
 #include "util.hpp"
 
 size_t utf8_len(const std::string& s);
@@ -33,6 +26,34 @@ enum class FigletType
     Smushed
 };
 
+// Off-screen cell buffer, as big as the terminal, for the parts of a scene
+// that rarely change (borders, boxes, labels).
+// It gets drawn once between TerminalDisplay::beginLayer() and endLayer() with the usual
+// draw functions, then TerminalDisplay keeps it composited under every frame by itself.
+// Cells never drawn are transparent. Layers with a higher z end up on top.
+class DisplayLayer
+{
+public:
+    explicit DisplayLayer(int z = 0) : m_z(z) {}
+
+    // True if the layer has to be drawn (again): never drawn,
+    // invalidated or the terminal got resized since then
+    bool stale() const;
+    void invalidate() { m_drawn = false; }
+    int  z() const { return m_z; }
+
+private:
+    friend class TerminalDisplay;
+
+    int  m_z;
+    int  m_width  = 0;
+    int  m_height = 0;
+    bool m_drawn  = false;
+
+    std::vector<tb_cell> m_cells;  // ch == 0 means transparent
+    std::vector<RowSpan> m_rows;
+};
+
 // A similiar clone of Adafruit_SSD130 for terminals
 class TerminalDisplay
 {
@@ -44,12 +65,14 @@ public:
           m_cursor_y(0),
           m_fg_col(0),
           m_bg_col(0),
-          m_flf_font(nullptr),
-          m_figlet()
+          m_flf_font(nullptr)
     {}
     ~TerminalDisplay();
 
-    bool begin();
+    // Uses the termbox backend (the real terminal) if `backend` is null
+    bool begin(std::unique_ptr<DisplayBackend> backend = nullptr);
+    void end();
+    bool ready() const;
     void clearDisplay();
     void setCursor(const int x, const int y);
     void setTextColor(const uintattr_t hex);
@@ -58,78 +81,167 @@ public:
     void setFont(FigletType figlet_type, const std::string_view font);
     void resetFont();
     void updateDims();
+
+    // The terminal got resized, maybe to the same size (termbox wipes the screen and its front buffer either way):
+    // pick up the size and present everything again
+    void handleResize();
     void drawLine(int x0, int y0, int x1, int y1, uint32_t ch);
     void drawCircle(int center_x, int center_y, int radius, uint32_t ch);
     void drawRect(int x, int y, int width, int height, uint32_t ch);
     void drawFilledRect(int x, int y, int width, int height, uint32_t ch);
     void drawPixel(int x, int y, uint32_t ch);
+    void drawFastHLine(int x, int y, int width, uint32_t ch);
+    void drawFastVLine(int x, int y, int height, uint32_t ch);
+
+    // Move the cells of the rectangle down by `n` rows, the `n` rows left at its top get blanked.
+    // The terminal scrolls the rows by itself (DECSTBM), so they aren't sent again cell by cell.
+    void scrollRect(int x, int y, int width, int height, int n);
     void display();
 
+    // Frame transaction: display() calls made between beginFrame() and endFrame()
+    // are coalesced into a single present (and a single write) at endFrame().
+    void beginFrame();
+    void endFrame();
+
+    // Redirect all drawing into `layer` until endLayer(), the layer gets resized and cleared.
+    // Draw layers before the dynamic content of the frame, which always stays on top of them.
+    void beginLayer(DisplayLayer& layer);
+    void endLayer();
+
+    // Set the layers composited under each frame. Returns true if they differ from the previous ones.
+    bool setLayers(const std::vector<DisplayLayer*>& layers);
+
+    // Stop using `layers` (their owner is going away), whichever of them are set or being drawn
+    void removeLayers(const std::vector<DisplayLayer*>& layers);
+
     template <typename... Args>
-    void print(const std::string_view fmt, Args&&... args)
+    void print(std::format_string<Args...> fmt, Args&&... args)
     {
-        const std::string& text = m_figlet ? (*m_figlet)(std::vformat(fmt, std::make_format_args(args...)))
-                                           : std::vformat(fmt, std::make_format_args(args...));
-
-        const std::vector<std::string>& text_lines = split(text, '\n');
-
-        int max_width = 0;
-        for (const auto& line : text_lines)
-        {
-            tb_print(m_cursor_x, m_cursor_y, m_fg_col, m_bg_col, line.c_str());
-            m_cursor_y++;
-            max_width = std::max<int>(max_width, static_cast<int>(utf8_len(line)));
-        }
-
-        m_cursor_x += max_width;
-
-        if (m_cursor_x >= static_cast<int>(m_width))
-        {
-            m_cursor_x = 0;
-            m_cursor_y++;
-            if (m_cursor_y >= static_cast<int>(m_height))
-                m_cursor_y = m_height - 1;
-        }
+        print(format<Args...>(fmt, std::forward<Args>(args)...));
     }
 
     template <typename... Args>
-    void centerText(int y, const std::string_view fmt, Args&&... args)
+    void centerText(int y, std::format_string<Args...> fmt, Args&&... args)
     {
-        const std::string& text = m_figlet ? (*m_figlet)(std::vformat(fmt, std::make_format_args(args...)))
-                                           : std::vformat(fmt, std::make_format_args(args...));
-
-        const std::vector<std::string>& text_lines = split(text, '\n');
-        size_t                          max_width  = 0;
-        for (const auto& line : text_lines)
-            max_width = std::max(max_width, utf8_len(line));
-
-        int current_y = y;
-        for (const auto& line : text_lines)
-        {
-            int x = (m_width - static_cast<int>(utf8_len(line))) / 2;
-            x     = std::max(0, x);
-
-            tb_print(x, current_y++, m_fg_col, m_bg_col, line.c_str());
-            setCursor(x, current_y);
-        }
+        centerText(y, format<Args...>(fmt, std::forward<Args>(args)...));
     }
 
+    // Same as above, but `text` is printed as it is, no formatting
+    void print(std::string_view text);
+    void centerText(int y, std::string_view text);
+
     int getWidth() const { return m_width; }
     int getHeight() const { return m_height; }
     int getCursorX() const { return m_cursor_x; }
     int getCursorY() const { return m_cursor_y; }
 
+    const DisplayStats& getStats() const { return m_stats; }
+
+    // Count a frame the game loop skipped rendering
+    void dropFrame() { ++m_stats.frames_dropped; }
+
+    // True if the last present got held back (the terminal is still busy with the one before),
+    // it goes out with the next present
+    bool outputPending() const { return m_backend && m_backend->hasHeldChanges(); }
+
+    // Map the settings colors for the output mode picked by settings.general.color_mode,
+    // call it after changing either. Layers get invalidated if the colors changed.
+    void refreshPalette();
+
+    // Turn the reporting of key repeats and releases on or off as settings.general.key_events says,
+    // call it after changing it
+    void refreshKeyEvents();
+
+    // True if the terminal reports them, so held keys can be told apart from tapped ones
+    bool keyEventsReported() const { return m_backend && m_backend->keyEventsReported(); }
+
+    // tb_peek_event(), once the output can't get mixed up with what termbox writes on a resize
+    // (see DisplayBackend::beforeInput()). True with the event in `ev`
+    bool peekEvent(tb_event& ev, int timeout_ms);
+
     // Return a column/row that is `p` percent (0.0–1.0) across the terminal
     int pctX(float p) const { return static_cast<int>(m_width * p); }
     int pctY(float p) const { return static_cast<int>(m_height * p); }
 
 private:
+    void             markDirty(int y, int x0, int x1);
+    void             markAllDirty();
+    void             forgetLayers();
+    void             present();
+    void             compose();
+    void             setCell(int x, int y, uint32_t ch);
+    bool             targetRow(int y, tb_cell*& row, int& width);
+    int              putText(int x, int y, std::string_view text);
+    std::string_view figletText(std::string_view text);
+    uintattr_t       mapColor(uintattr_t col) const;
+
+    // Format into a buffer reused between calls, so printing doesn't allocate.
+    // The returned view is valid until the next call.
+    template <typename... Args>
+    std::string_view format(std::format_string<Args...> fmt, Args&&... args)
+    {
+        // Args are spelled out so fmt keeps matching the format_string the caller got checked against
+        const auto result = std::format_to_n<char*, Args...>(m_text_buf.data(), m_text_buf.size(), fmt,
+                                                             std::forward<Args>(args)...);
+        if (static_cast<size_t>(result.size) <= m_text_buf.size())
+            return { m_text_buf.data(), static_cast<size_t>(result.size) };
+
+        // Too long, m_text_spill keeps its capacity for the next time
+        m_text_spill.clear();
+        std::format_to<std::back_insert_iterator<std::string>, Args...>(std::back_inserter(m_text_spill), fmt,
+                                                                        std::forward<Args>(args)...);
+        return m_text_spill;
+    }
+
     int        m_width, m_height;
     int        m_cursor_x, m_cursor_y;
     uintattr_t m_fg_col, m_bg_col;
 
-    std::shared_ptr<flf_font> m_flf_font;
-    std::optional<figlet>     m_figlet;
+    // TB_BLACK..TB_WHITE as settings.colors has them, in the output mode's colors
+    std::array<uintattr_t, TB_WHITE + 1> m_palette{};
+
+    std::unique_ptr<DisplayBackend> m_backend;
+
+    // Fonts get loaded once and text rendered with them kept around,
+    // since scenes set their font and draw the same titles every frame
+    struct LoadedFont
+    {
+        std::string               assets_path;
+        std::string               name;
+        std::shared_ptr<flf_font> font;
+    };
+    struct FigletArt
+    {
+        const flf_font* font;
+        FigletType      type;
+        std::string     text;
+        std::string     art;
+    };
+    std::vector<LoadedFont>   m_fonts;
+    std::vector<FigletArt>    m_figlet_art;
+    std::shared_ptr<flf_font> m_flf_font;  // current one, null if none
+    FigletType                m_figlet_type = FigletType::FullWidth;
+
+    std::array<char, 256> m_text_buf;
+    std::string           m_text_spill;
+
+    // m_dirty: rows changed since the last present, only those get diffed.
+    // m_content: rows drawn over the layers since the last clear, only those get restored.
+    // m_row_hash: hash of each row as it was last presented, 0 if unknown.
+    std::vector<RowSpan>  m_dirty;
+    std::vector<RowSpan>  m_content;
+    std::vector<uint64_t> m_row_hash;
+    DisplayStats          m_stats;
+
+    // Layers composited together, what the back buffer gets reset to on clear
+    std::vector<DisplayLayer*> m_layers;
+    std::vector<tb_cell>       m_base;
+    std::vector<RowSpan>       m_base_rows;
+    DisplayLayer*              m_target       = nullptr;
+    bool                       m_layers_dirty = false;
+
+    int  m_frame_depth     = 0;
+    bool m_present_pending = false;
 };
 
 extern TerminalDisplay display;
@@ -122,7 +122,7 @@ inline std::vector<std::string> split(const std::string_view text, const char de
 {
     std::string              line;
     std::vector<std::string> vec;
-    std::stringstream        ss(text.data());
+    std::stringstream        ss{ std::string(text) };
     while (std::getline(ss, line, delim))
     {
         vec.push_back(line);
@@ -1,5 +1,6 @@
 #include "audio_player.hpp"
 
+#include <algorithm>
 #include <cstdio>
 #include <string>
 
@@ -10,6 +11,8 @@ AudioPlayer::~AudioPlayer()
     // Sounds must be uninitialized before the engine they belong to
     unloadMusic();
     unloadSfx();
+    for (const std::string& path : m_preloaded)
+        ma_resource_manager_unregister_file(ma_engine_get_resource_manager(&m_engine), path.c_str());
 
     if (m_engine_ready)
         ma_engine_uninit(&m_engine);
@@ -46,8 +49,10 @@ void AudioPlayer::playMusic(const char* audio)
     unloadMusic();
     m_current_music = path;
 
-    ma_result result =
-        ma_sound_init_from_file(&m_engine, path.c_str(), MA_SOUND_FLAG_STREAM, nullptr, nullptr, &m_music);
+    // Opening and decoding the start of the track happens on miniaudio's job thread,
+    // it starts playing once that's done instead of holding up the frame
+    ma_result result = ma_sound_init_from_file(
+        &m_engine, path.c_str(), MA_SOUND_FLAG_STREAM | MA_SOUND_FLAG_ASYNC, nullptr, nullptr, &m_music);
 
     if (result != MA_SUCCESS)
     {
@@ -127,6 +132,30 @@ void AudioPlayer::stopSfx()
         ma_sound_stop(&m_sfx);
 }
 
+void AudioPlayer::preloadSfx(const char* audio)
+{
+    if (!m_engine_ready)
+        return;
+
+    const std::string path = settings.general.assets_path + "/audios/" + audio;
+    if (std::find(m_preloaded.begin(), m_preloaded.end(), path) != m_preloaded.end())
+        return;
+
+    // Sounds initialized from the same path share the registered data instead of decoding it again
+    ma_result result = ma_resource_manager_register_file(
+        ma_engine_get_resource_manager(&m_engine),
+        path.c_str(),
+        MA_RESOURCE_MANAGER_DATA_SOURCE_FLAG_DECODE | MA_RESOURCE_MANAGER_DATA_SOURCE_FLAG_ASYNC);
+
+    if (result != MA_SUCCESS)
+    {
+        fprintf(stderr, "[audio] Failed to preload sfx '%s': %s\n", path.c_str(), ma_result_description(result));
+        return;
+    }
+
+    m_preloaded.push_back(path);
+}
+
 void AudioPlayer::setSfxVolume(float volume)
 {
     m_sfx_volume = volume;
@@ -0,0 +1,304 @@
+#include "bench.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <format>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "games/2048.hpp"
+#include "games/snake.hpp"
+#include "games/tetris.hpp"
+#include "games/tictactoe.hpp"
+#include "games/wordle.hpp"
+#include "scenes/credits.hpp"
+#include "scenes/games_menu.hpp"
+#include "scenes/main_menu.hpp"
+#include "scenes/settings.hpp"
+#include "settings.hpp"
+#include "terminal_display.hpp"
+
+struct BenchScene
+{
+    const char*                             name;
+    std::function<std::unique_ptr<Scene>()> make;
+};
+
+// clang-format off
+static const BenchScene SCENES[] = {
+    { "main",     [] { return std::make_unique<MainMenuScene>(); } },
+    { "games",    [] { return std::make_unique<GamesMenuScene>(); } },
+    { "settings", [] { return std::make_unique<SettingsScene>(); } },
+    { "credits",  [] { return std::make_unique<CreditsScene>(); } },
+    { "tetris",   [] { return std::make_unique<TetrisGame>(); } },
+    { "ttt",      [] { return std::make_unique<TTTGame>(); } },
+    { "snake",    [] { return std::make_unique<SnakeGame>(); } },
+    { "wordle",   [] { return std::make_unique<WordleGame>(); } },
+    { "2048",     [] { return std::make_unique<Game2048>(); } },
+};
+// clang-format on
+
+struct BenchResult
+{
+    std::string name;
+    double      pixel_rate;  // cells/sec drawing with drawPixel() one cell at a time
+    double      span_rate;   // cells/sec with the span primitives
+};
+
+// Call `draw` for a while, return how many cells per second it got through
+static double measure(const std::function<void()>& draw, size_t cells)
+{
+    const auto       start = steady_clock::now();
+    size_t           runs  = 0;
+    duration<double> elapsed{};
+    do
+    {
+        draw();
+        ++runs;
+        elapsed = steady_clock::now() - start;
+    } while (elapsed < 300ms);
+
+    return static_cast<double>(runs * cells) / elapsed.count();
+}
+
+static void fill_pixels(int x, int y, int width, int height, uint32_t ch)
+{
+    for (int row = y; row < y + height; ++row)
+        for (int col = x; col < x + width; ++col)
+            display.drawPixel(col, row, ch);
+}
+
+static void rect_pixels(int x, int y, int width, int height, uint32_t ch)
+{
+    for (int col = x; col < x + width; ++col)
+    {
+        display.drawPixel(col, y, ch);
+        display.drawPixel(col, y + height - 1, ch);
+    }
+    for (int row = y + 1; row < y + height - 1; ++row)
+    {
+        display.drawPixel(x, row, ch);
+        display.drawPixel(x + width - 1, row, ch);
+    }
+}
+
+// Parse "WIDTHxHEIGHT", keeps the defaults if it isn't one
+static void parse_size(const char* arg, int& width, int& height)
+{
+    int w = 0, h = 0;
+    if (arg && sscanf(arg, "%dx%d", &w, &h) == 2 && w > 0 && h > 0)
+    {
+        width  = w;
+        height = h;
+    }
+}
+
+static HeadlessBackend* begin_headless(int width, int height)
+{
+    auto             backend  = std::make_unique<HeadlessBackend>(width, height);
+    HeadlessBackend* headless = backend.get();
+    if (!display.begin(std::move(backend)))
+        return nullptr;
+
+    return headless;
+}
+
+// Render `scene` for a while, return the frames per second
+static double measure_scene(Scene& scene, size_t& cells_changed, double& skipped)
+{
+    const DisplayStats before = display.getStats();
+    const auto         start  = steady_clock::now();
+    size_t             frames = 0;
+    duration<double>   elapsed{};
+    cells_changed = 0;
+    do
+    {
+        if (scene.frame_ms() > 0)
+            scene.update(milliseconds(scene.frame_ms()));
+        scene.render_all();
+        cells_changed += display.getStats().cells_changed;
+        ++frames;
+        elapsed = steady_clock::now() - start;
+    } while (elapsed < 300ms);
+
+    cells_changed /= frames;
+    skipped = 100.0 * (display.getStats().frames_skipped - before.frames_skipped) / frames;
+    return frames / elapsed.count();
+}
+
+// Bytes sent for the first frame of the scene `entry` on a blank screen, with or without the compact encoding
+static size_t first_frame_bytes(const BenchScene& entry, int width, int height, bool compact, ColorMode colors)
+{
+    const Settings::general_settings_t saved = settings.general;
+    settings.general.compact_output          = compact;
+    settings.general.color_mode              = colors;
+
+    size_t bytes = 0;
+    if (begin_headless(width, height))
+    {
+        std::unique_ptr<Scene> scene = entry.make();
+        if (scene->begin().ok())
+        {
+            scene->render_all();
+            bytes = display.getStats().bytes_written;
+        }
+    }
+
+    settings.general = saved;
+    return bytes;
+}
+
+// Draw the 2048 board on a `width`x`height` screen, then return how many cells per second
+// present() gets through diffing all of it again while nothing changed
+static double measure_diff(int width, int height)
+{
+    HeadlessBackend* headless = begin_headless(width, height);
+    if (!headless)
+        return 0;
+
+    Game2048 game;
+    if (!game.begin().ok())
+        return 0;
+    game.render_all();
+
+    std::vector<RowSpan> dirty(height);
+    DisplayStats         stats;
+    return measure(
+        [&] {
+            std::fill(dirty.begin(), dirty.end(), RowSpan{ 0, width - 1 });
+            headless->present(dirty, stats);
+        },
+        static_cast<size_t>(width) * height);
+}
+
+int run_benchmarks(int argc, char* argv[])
+{
+    int w = 120;
+    int h = 40;
+    parse_size(argc > 0 ? argv[0] : nullptr, w, h);
+    if (!begin_headless(w, h))
+        return 1;
+
+    // 2048 sized tiles
+    const int tile_w = std::max(3, std::min((w / 2) / 4, (h / 2) / 4));
+    const int tiles  = 16;
+
+    std::vector<BenchResult> results;
+
+    display.setTextBgColor(TB_BLUE);
+    results.push_back({ std::format("fill {}x{}", w, h),
+                        measure([&] { fill_pixels(0, 0, w, h, ' '); }, w * h),
+                        measure([&] { display.drawFilledRect(0, 0, w, h, ' '); }, w * h) });
+
+    results.push_back({ std::format("{} tiles {}x{}", tiles, tile_w, tile_w),
+                        measure(
+                            [&] {
+                                for (int i = 0; i < tiles; ++i)
+                                    fill_pixels((i % 4) * tile_w, (i / 4) * tile_w, tile_w, tile_w, ' ');
+                            },
+                            tiles * tile_w * tile_w),
+                        measure(
+                            [&] {
+                                for (int i = 0; i < tiles; ++i)
+                                    display.drawFilledRect((i % 4) * tile_w, (i / 4) * tile_w, tile_w, tile_w, ' ');
+                            },
+                            tiles * tile_w * tile_w) });
+
+    const size_t outline = 2 * w + 2 * (h - 2);
+    results.push_back({ std::format("rect {}x{}", w, h),
+                        measure([&] { rect_pixels(0, 0, w, h, '#'); }, outline),
+                        measure([&] { display.drawRect(0, 0, w, h, '#'); }, outline) });
+
+    display.clearDisplay();
+
+    printf("%-20s %17s %17s\n", "benchmark", "drawPixel", "span");
+    for (const BenchResult& r : results)
+        printf("%-20s %12.1f Mc/s %12.1f Mc/s  (%.1fx)\n", r.name.c_str(), r.pixel_rate / 1e6, r.span_rate / 1e6,
+               r.span_rate / r.pixel_rate);
+
+    printf("\n%-20s %12s %17s %9s %14s %14s %14s\n", "scene", "frames/s", "cells changed", "skipped", "plain bytes",
+           "compact bytes", "compact 256c");
+    for (const BenchScene& entry : SCENES)
+    {
+        std::unique_ptr<Scene> scene = entry.make();
+        const Result<>&        r     = scene->begin();
+        if (!r.ok())
+        {
+            printf("%-20s %s\n", entry.name, r.error_v().c_str());
+            continue;
+        }
+
+        size_t       cells_changed = 0;
+        double       skipped       = 0;
+        const double fps           = measure_scene(*scene, cells_changed, skipped);
+        scene.reset();
+
+        const size_t plain       = first_frame_bytes(entry, w, h, false, ColorMode::TrueColor);
+        const size_t compact     = first_frame_bytes(entry, w, h, true, ColorMode::TrueColor);
+        const size_t compact_256 = first_frame_bytes(entry, w, h, true, ColorMode::Colors256);
+        printf("%-20s %12.0f %17zu %8.0f%% %14zu %14zu %14zu\n", entry.name, fps, cells_changed, skipped, plain,
+               compact, compact_256);
+    }
+
+    printf("\n%-20s %17s\n", "present diff", "unchanged");
+    for (const int scale : { 1, 2, 4 })
+        printf("%-20s %12.1f Mc/s\n", std::format("2048 {}x{}", w * scale, h * scale).c_str(),
+               measure_diff(w * scale, h * scale) / 1e6);
+
+    return 0;
+}
+
+int dump_scene(int argc, char* argv[])
+{
+    if (argc < 1)
+    {
+        fprintf(stderr, "usage: cliboy --dump SCENE [WIDTHxHEIGHT] [--ansi]\n");
+        return 1;
+    }
+
+    const std::string_view name = argv[0];
+    bool                   ansi = false;
+    int                    w    = 120;
+    int                    h    = 40;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::string_view(argv[i]) == "--ansi")
+            ansi = true;
+        else
+            parse_size(argv[i], w, h);
+    }
+
+    const auto it =
+        std::find_if(std::begin(SCENES), std::end(SCENES), [&](const BenchScene& s) { return s.name == name; });
+    if (it == std::end(SCENES))
+    {
+        fprintf(stderr, "unknown scene '%s', one of:", argv[0]);
+        for (const BenchScene& entry : SCENES)
+            fprintf(stderr, " %s", entry.name);
+        fprintf(stderr, "\n");
+        return 1;
+    }
+
+    HeadlessBackend* headless = begin_headless(w, h);
+    if (!headless)
+        return 1;
+
+    std::unique_ptr<Scene> scene = it->make();
+    const Result<>&        r     = scene->begin();
+    if (!r.ok())
+    {
+        fprintf(stderr, "Error while initing the scene: %s\n", r.error_v().c_str());
+        return 1;
+    }
+
+    // Same as the first frame of the game loop, rendered before any tick
+    scene->render_all();
+
+    const std::string& frame = ansi ? headless->dumpAnsi() : headless->dumpText();
+    fwrite(frame.data(), 1, frame.size(), stdout);
+    return 0;
+}
@@ -0,0 +1,1223 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <iterator>
+#include <string>
+
+#define TB_IMPL 1
+#include "display_backend.hpp"
+#include "frame_arena.hpp"
+#include "settings.hpp"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#  include <immintrin.h>
+#endif
+
+#ifndef _WIN32
+#  include <poll.h>
+#endif
+
+static constexpr const char* SYNC_OUTPUT_BEGIN = "\x1b[?2026h";
+static constexpr const char* SYNC_OUTPUT_END   = "\x1b[?2026l";
+
+// Below SLOW_OUTPUT_RATE bytes/s, measured every SLOW_OUTPUT_WINDOW bytes,
+// the terminal gets fewer colors to cut the size of the SGRs
+static constexpr size_t SLOW_OUTPUT_WINDOW = 64 * 1024;
+static constexpr double SLOW_OUTPUT_RATE   = 128 * 1024;
+
+static void enable_ansi_colors()
+{
+#ifdef _WIN32
+    HANDLE hOut = GetStdHandle(STD_OUTPUT_HANDLE);
+    if (hOut == INVALID_HANDLE_VALUE)
+        return;
+
+    DWORD mode = 0;
+    if (!GetConsoleMode(hOut, &mode))
+        return;
+
+    mode |= ENABLE_VIRTUAL_TERMINAL_PROCESSING;
+    SetConsoleMode(hOut, mode);
+#endif
+}
+
+// -------------------------------------
+// Termbox
+// -------------------------------------
+
+// Colors the terminal claims to support
+static int detect_output_mode()
+{
+    const char* colorterm = getenv("COLORTERM");
+    if (colorterm && (strcmp(colorterm, "truecolor") == 0 || strcmp(colorterm, "24bit") == 0))
+        return TB_OUTPUT_TRUECOLOR;
+
+    const char* term = getenv("TERM");
+    if (term && strstr(term, "direct"))
+        return TB_OUTPUT_TRUECOLOR;
+    if (term && strstr(term, "256color"))
+        return TB_OUTPUT_256;
+
+#ifdef _WIN32
+    return TB_OUTPUT_TRUECOLOR;
+#else
+    return TB_OUTPUT_NORMAL;
+#endif
+}
+
+bool TermboxBackend::init()
+{
+    enable_ansi_colors();
+    if (tb_init() < 0)
+        return false;
+
+    m_preferred_mode = detect_output_mode();
+    m_window_bytes   = 0;
+    m_window_secs    = 0;
+    m_sent_width     = -1;
+    m_sent_height    = -1;
+    m_scroll.clear();
+    tb_set_output_mode(m_preferred_mode);
+    tb_hide_cursor();
+    return true;
+}
+
+TermboxBackend::~TermboxBackend()
+{
+    stopWriter();
+}
+
+void TermboxBackend::shutdown()
+{
+    stopWriter();
+    if (m_key_events && ready())
+        setKeyEvents(false);
+    tb_shutdown();
+}
+
+bool TermboxBackend::ready() const
+{
+    return global.initialized;
+}
+
+int TermboxBackend::width() const
+{
+    return tb_width();
+}
+
+int TermboxBackend::height() const
+{
+    return tb_height();
+}
+
+tb_cell* TermboxBackend::cells()
+{
+    return global.back.cells;
+}
+
+int TermboxBackend::outputMode() const
+{
+    return global.output_mode;
+}
+
+void TermboxBackend::setOutputMode(int mode)
+{
+    tb_set_output_mode(mode);
+}
+
+// -------------------------------------
+// Keyboard
+// -------------------------------------
+
+// Kitty keyboard protocol flags asked for: disambiguate escape codes (1), report event types (2),
+// report all keys as escape codes (8) and the text they produce (16).
+// With 8 every key, even plain letters, comes as CSI code;mods:event;text u, so a release can't be missed.
+static constexpr int KITTY_KEY_FLAGS = 1 | 2 | 8 | 16;
+
+// Set when the terminal answers the CSI ? u query with event types in its flags
+static bool key_events_reported = false;
+
+KeyAction key_action(const tb_event& ev)
+{
+    // extract_kitty_key() puts it in w, which key events don't use (wait_event() zeroes it)
+    switch (ev.w)
+    {
+        case 2:  return KeyAction::Repeat;
+        case 3:  return KeyAction::Release;
+        default: return KeyAction::Press;
+    }
+}
+
+// Key of a functional key code (the private use area ones, and the few below 0x20 + delete),
+// 0 for the ones the games have no use for, like the modifiers on their own
+static uint16_t kitty_functional_key(uint32_t code)
+{
+    switch (code)
+    {
+        case 27:    return TB_KEY_ESC;
+        case 13:    return TB_KEY_ENTER;
+        case 9:     return TB_KEY_TAB;
+        case 8:
+        case 127:   return TB_KEY_BACKSPACE2;
+        case 57414: return TB_KEY_ENTER;  // keypad
+        case 57417: return TB_KEY_ARROW_LEFT;
+        case 57418: return TB_KEY_ARROW_RIGHT;
+        case 57419: return TB_KEY_ARROW_UP;
+        case 57420: return TB_KEY_ARROW_DOWN;
+        case 57421: return TB_KEY_PGUP;
+        case 57422: return TB_KEY_PGDN;
+        case 57423: return TB_KEY_HOME;
+        case 57424: return TB_KEY_END;
+        case 57425: return TB_KEY_INSERT;
+        case 57426: return TB_KEY_DELETE;
+        default:    return 0;
+    }
+}
+
+// Key of a CSI number ~
+static uint16_t tilde_key(uint32_t n)
+{
+    switch (n)
+    {
+        case 2:  return TB_KEY_INSERT;
+        case 3:  return TB_KEY_DELETE;
+        case 5:  return TB_KEY_PGUP;
+        case 6:  return TB_KEY_PGDN;
+        case 7:  return TB_KEY_HOME;
+        case 8:  return TB_KEY_END;
+        case 11: return TB_KEY_F1;
+        case 12: return TB_KEY_F2;
+        case 13: return TB_KEY_F3;
+        case 14: return TB_KEY_F4;
+        case 15: return TB_KEY_F5;
+        case 17: return TB_KEY_F6;
+        case 18: return TB_KEY_F7;
+        case 19: return TB_KEY_F8;
+        case 20: return TB_KEY_F9;
+        case 21: return TB_KEY_F10;
+        case 23: return TB_KEY_F11;
+        case 24: return TB_KEY_F12;
+        default: return 0;
+    }
+}
+
+// Key of a CSI [1;mods] letter
+static uint16_t letter_key(char c)
+{
+    switch (c)
+    {
+        case 'A': return TB_KEY_ARROW_UP;
+        case 'B': return TB_KEY_ARROW_DOWN;
+        case 'C': return TB_KEY_ARROW_RIGHT;
+        case 'D': return TB_KEY_ARROW_LEFT;
+        case 'H': return TB_KEY_HOME;
+        case 'F': return TB_KEY_END;
+        case 'P': return TB_KEY_F1;
+        case 'Q': return TB_KEY_F2;
+        case 'S': return TB_KEY_F4;
+        default:  return 0;
+    }
+}
+
+// Drop the first `len` bytes of the input, a sequence with no key in it, and extract the event after it instead.
+// Returning TB_OK without an event would hand the game loop an empty one.
+static int skip_sequence(tb_event* ev, size_t len, size_t* consumed)
+{
+    bytebuf_shift(&global.in, len);
+    *consumed = 0;
+
+    // Nothing complete left: termbox waits for more input (or reports no event) instead of making up a key
+    return extract_event(ev) == TB_OK ? TB_OK : TB_ERR_NEED_MORE;
+}
+
+// termbox hook (TB_FUNC_EXTRACT_PRE) for the CSI sequences of the kitty keyboard protocol,
+// called with the input starting with ESC before termbox looks it up in its terminfo keys.
+// Anything it doesn't know is left to termbox, what has no key for the games (the answer to the query,
+// a modifier on its own, paste brackets) gets dropped.
+static int extract_kitty_key(tb_event* ev, size_t* consumed)
+{
+    const bytebuf& in = global.in;
+    if (in.len < 2 || in.buf[1] != '[')
+        return TB_ERR;
+
+    size_t     i     = 2;
+    const bool query = i < in.len && in.buf[i] == '?';
+    if (query)
+        ++i;
+
+    // Up to 3 ;-separated fields of up to 2 :-separated numbers each, 0 when left out
+    uint32_t fields[3][2]{};
+    int      field = 0, sub = 0;
+    for (; i < in.len; ++i)
+    {
+        const char c = in.buf[i];
+        if (c >= '0' && c <= '9')
+        {
+            if (field < 3 && sub < 2)
+                fields[field][sub] = fields[field][sub] * 10 + (c - '0');
+        }
+        else if (c == ';')
+        {
+            ++field;
+            sub = 0;
+        }
+        else if (c == ':')
+        {
+            ++sub;
+        }
+        else
+        {
+            break;
+        }
+    }
+    if (i >= in.len)
+        return TB_ERR_NEED_MORE;
+
+    const char final = in.buf[i];
+    *consumed        = i + 1;
+
+    if (query)
+    {
+        // Answer to CSI ? u, no key in it
+        if (final != 'u')
+            return TB_ERR;
+        key_events_reported = fields[0][0] & 2;
+        return skip_sequence(ev, i + 1, consumed);
+    }
+
+    const uint32_t code = fields[0][0];
+    const uint32_t mods = fields[1][0] > 0 ? fields[1][0] - 1 : 0;
+    const uint32_t kind = fields[1][1];
+    const uint32_t text = fields[2][0];
+
+    uint16_t key = 0;
+    uint32_t ch  = 0;
+    if (final == 'u')
+    {
+        key = kitty_functional_key(code);
+        if (key == 0 && code >= 0x20 && (code < 0xe000 || code > 0xf8ff))
+        {
+            if ((mods & 4) && code >= 'a' && code <= 'z')
+                key = TB_KEY_CTRL_A + (code - 'a');
+            else if (text)
+                ch = text;
+            else
+                ch = (mods & 1) && code >= 'a' && code <= 'z' ? code - 'a' + 'A' : code;
+        }
+    }
+    else if (final == '~')
+    {
+        key = tilde_key(code);
+    }
+    else if ((key = letter_key(final)) == 0)
+    {
+        return TB_ERR;
+    }
+
+    if (key == 0 && ch == 0)
+        return skip_sequence(ev, i + 1, consumed);
+
+    if (key == TB_KEY_TAB && (mods & 1))
+        key = TB_KEY_BACK_TAB;
+
+    ev->type = TB_EVENT_KEY;
+    ev->key  = key;
+    ev->ch   = ch;
+    ev->mod  = ((mods & 1) ? TB_MOD_SHIFT : 0) | ((mods & 2) ? TB_MOD_ALT : 0) | ((mods & 4) ? TB_MOD_CTRL : 0);
+    ev->w    = kind == 2 || kind == 3 ? kind : 1;
+    return TB_OK;
+}
+
+void TermboxBackend::setKeyEvents(bool enable)
+{
+    if (!ready() || enable == m_key_events)
+        return;
+
+    // Straight to the tty, nothing else is being written once the writer is idle
+    waitWriterIdle();
+    if (enable)
+    {
+        // Push the flags on the terminal's stack, then ask what it made of them
+        writeFrame(std::format("\x1b[>{}u\x1b[?u", KITTY_KEY_FLAGS));
+        tb_set_func(TB_FUNC_EXTRACT_PRE, extract_kitty_key);
+    }
+    else
+    {
+        writeFrame("\x1b[<u");
+        tb_set_func(TB_FUNC_EXTRACT_PRE, nullptr);
+        key_events_reported = false;
+    }
+    m_key_events = enable;
+}
+
+bool TermboxBackend::keyEventsReported() const
+{
+    return m_key_events && key_events_reported;
+}
+
+void TermboxBackend::beforeInput(bool blocking)
+{
+    if (!m_writer.joinable() || !ready())
+        return;
+
+#ifndef _WIN32
+    // SIGWINCH came in if termbox's handler wrote to its pipe
+    pollfd resize{ global.resize_pipefd[0], POLLIN, 0 };
+    if (!blocking && poll(&resize, 1, 0) <= 0)
+        return;
+#endif
+    waitWriterIdle();
+}
+
+// -------------------------------------
+// Colors
+// -------------------------------------
+
+// The xterm 256 colors palette: 16 system colors, a 6x6x6 cube, then 24 grays
+static constexpr uint8_t CUBE_LEVELS[] = { 0, 95, 135, 175, 215, 255 };
+
+static constexpr uint32_t SYSTEM_COLORS[] = {
+    0x000000, 0xcd0000, 0x00cd00, 0xcdcd00, 0x0000ee, 0xcd00cd, 0x00cdcd, 0xe5e5e5,
+    0x7f7f7f, 0xff0000, 0x00ff00, 0xffff00, 0x5c5cff, 0xff00ff, 0x00ffff, 0xffffff,
+};
+
+static int color_distance(uint32_t a, uint32_t b)
+{
+    const int dr = static_cast<int>((a >> 16) & 0xff) - static_cast<int>((b >> 16) & 0xff);
+    const int dg = static_cast<int>((a >> 8) & 0xff) - static_cast<int>((b >> 8) & 0xff);
+    const int db = static_cast<int>(a & 0xff) - static_cast<int>(b & 0xff);
+
+    // weighted like the eye sees it, green counts the most
+    return 2 * dr * dr + 4 * dg * dg + 3 * db * db;
+}
+
+static int cube_index(int v)
+{
+    return v < 48 ? 0 : v < 115 ? 1 : (v - 35) / 40;
+}
+
+static uint8_t quantize_256(uint32_t rgb)
+{
+    const int r = (rgb >> 16) & 0xff;
+    const int g = (rgb >> 8) & 0xff;
+    const int b = rgb & 0xff;
+
+    const int      ri   = cube_index(r), gi = cube_index(g), bi = cube_index(b);
+    const uint32_t cube = (CUBE_LEVELS[ri] << 16) | (CUBE_LEVELS[gi] << 8) | CUBE_LEVELS[bi];
+
+    const int      gray_i = std::clamp(((r + g + b) / 3 - 3) / 10, 0, 23);
+    const uint32_t level  = 8 + gray_i * 10;
+    const uint32_t gray   = (level << 16) | (level << 8) | level;
+
+    if (color_distance(rgb, gray) < color_distance(rgb, cube))
+        return 232 + gray_i;
+    return 16 + 36 * ri + 6 * gi + bi;
+}
+
+static uintattr_t quantize_16(uint32_t rgb)
+{
+    int best = 0;
+    for (int i = 1; i < 16; ++i)
+    {
+        if (color_distance(rgb, SYSTEM_COLORS[i]) < color_distance(rgb, SYSTEM_COLORS[best]))
+            best = i;
+    }
+
+    // TB_BLACK is 1, not 0
+    return (TB_BLACK + (best & 7)) | (best >= 8 ? TB_BRIGHT : 0);
+}
+
+uintattr_t quantize_color(uint32_t rgb, int mode)
+{
+    rgb &= 0xffffff;
+    switch (mode)
+    {
+        case TB_OUTPUT_256:    return quantize_256(rgb);
+        case TB_OUTPUT_NORMAL: return quantize_16(rgb);
+        default:               return rgb ? rgb : TB_HI_BLACK;  // 0 would be the default color
+    }
+}
+
+// -------------------------------------
+// Text width
+// -------------------------------------
+
+using WidthTable = std::array<uint8_t, 0x10000 / 4>;
+
+// Width + 1 of every BMP codepoint in 2 bits, 0 for the non-printable ones
+static const WidthTable& bmp_widths()
+{
+    static const WidthTable table = [] {
+        WidthTable t{};
+        for (uint32_t ch = 0; ch < 0x10000; ++ch)
+        {
+            const int code = tb_iswprint(ch) ? tb_wcwidth(ch) + 1 : 0;
+            t[ch / 4] |= static_cast<uint8_t>(code << (ch % 4 * 2));
+        }
+        return t;
+    }();
+    return table;
+}
+
+int cell_width(uint32_t ch)
+{
+    if (ch >= 0x20 && ch < 0x7f)
+        return 1;
+
+    if (ch < 0x10000)
+        return ((bmp_widths()[ch / 4] >> (ch % 4 * 2)) & 3) - 1;
+
+    return tb_wcwidth(ch);
+}
+
+uint32_t utf8_next(std::string_view text, size_t& i, int& w)
+{
+    const unsigned char c   = text[i];
+    const size_t        len = tb_utf8_char_length(c);
+
+    uint32_t ch = 0xfffd;
+    if (i + len <= text.size())
+    {
+        ch = c & utf8_mask[len - 1];
+        for (size_t k = 1; k < len; ++k)
+            ch = (ch << 6) | (text[i + k] & 0x3f);
+    }
+    i += len;
+
+    w = cell_width(ch);
+    if (w < 0)
+    {
+        ch = 0xfffd;
+        w  = 1;
+    }
+    return ch;
+}
+
+TextMetrics measure_text(std::string_view text)
+{
+    TextMetrics m;
+    m.bytes = text.size();
+
+    size_t i = 0;
+    while (i < text.size())
+    {
+        int w = 0;
+        utf8_next(text, i, w);
+        m.cells += w;
+        ++m.codepoints;
+    }
+    return m;
+}
+
+// -------------------------------------
+// Encoder
+// -------------------------------------
+
+static bool is_default_color(uintattr_t c, int mode)
+{
+    switch (mode)
+    {
+        case TB_OUTPUT_TRUECOLOR: return (c & 0xffffff) == 0 && (c & TB_HI_BLACK) == 0;
+        case TB_OUTPUT_256:       return (c & 0xff) == 0 && (c & TB_HI_BLACK) == 0;
+        default:                  return (c & 0xff) == 0;
+    }
+}
+
+// Append the SGR parameter (with its leading ';') setting `c` as fg or bg color,
+// the same way termbox's send_attr() maps them for each output mode
+template <typename String>
+static void append_color(String& out, uintattr_t c, bool bg, int mode)
+{
+    if (is_default_color(c, mode))
+    {
+        out += bg ? ";49" : ";39";
+        return;
+    }
+
+    switch (mode)
+    {
+        case TB_OUTPUT_TRUECOLOR:
+        {
+            const uint32_t rgb = (c & TB_HI_BLACK) ? 0 : (c & 0xffffff);
+            std::format_to(std::back_inserter(out), ";{};2;{};{};{}", bg ? 48 : 38, (rgb >> 16) & 0xff,
+                           (rgb >> 8) & 0xff, rgb & 0xff);
+            break;
+        }
+        case TB_OUTPUT_256:
+            std::format_to(std::back_inserter(out), ";{};5;{}", bg ? 48 : 38, (c & TB_HI_BLACK) ? 0 : (c & 0xff));
+            break;
+        default:
+            std::format_to(std::back_inserter(out), ";{}", (bg ? 40 : 30) + ((c & TB_BRIGHT) ? 60 : 0) + (c & 0x0f) - 1);
+            break;
+    }
+}
+
+static constexpr uintattr_t STYLE_FLAGS = TB_BOLD | TB_DIM | TB_ITALIC | TB_UNDERLINE | TB_BLINK | TB_REVERSE;
+
+// Full SGR: reset, then every style and both colors
+template <typename String>
+static void append_sgr(String& out, uintattr_t fg, uintattr_t bg, int mode)
+{
+    out += "\x1b[0";
+    if (fg & TB_BOLD)
+        out += ";1";
+    if (fg & TB_DIM)
+        out += ";2";
+    if (fg & TB_ITALIC)
+        out += ";3";
+    if (fg & TB_UNDERLINE)
+        out += ";4";
+    if (fg & TB_BLINK)
+        out += ";5";
+    if ((fg & TB_REVERSE) || (bg & TB_REVERSE))
+        out += ";7";
+
+    if (!is_default_color(fg, mode))
+        append_color(out, fg, false, mode);
+    if (!is_default_color(bg, mode))
+        append_color(out, bg, true, mode);
+
+    out += 'm';
+}
+
+// Turns the changed cells of a frame into escape sequences.
+// The plain mode does what tb_present() does: a full SGR on every attribute change
+// and an absolute move for every cell that doesn't follow the previous one.
+// The compact mode only sends the SGR parameters that changed, picks the shortest cursor motion
+// and collapses runs of the same cell with ECH (blanks) or REP.
+class AnsiEncoder
+{
+public:
+    AnsiEncoder(std::string& out, int width, bool compact, int mode)
+        : m_out(out), m_width(width), m_compact(compact), m_mode(mode)
+    {}
+
+    // Cells must come in row order, `w` is how many columns the cell covers
+    void put(int x, int y, const tb_cell& cell, int w)
+    {
+        if (!m_compact || w != 1)
+        {
+            flush();
+            emit(x, y, cell, w);
+            return;
+        }
+
+        if (m_run_len > 0 && y == m_run_y && x == m_run_x + m_run_len && cell.ch == m_run.ch && cell.fg == m_run.fg &&
+            cell.bg == m_run.bg)
+        {
+            ++m_run_len;
+            return;
+        }
+
+        flush();
+        m_run     = cell;
+        m_run_x   = x;
+        m_run_y   = y;
+        m_run_len = 1;
+    }
+
+    void flush()
+    {
+        if (m_run_len == 0)
+            return;
+
+        const int n = m_run_len;
+        m_run_len   = 0;
+
+        moveTo(m_run_x, m_run_y);
+        setAttr(m_run.fg, m_run.bg);
+
+        // Erasing doesn't move the cursor, so also count the move that follows
+        const std::string ech = std::format("\x1b[{}X", n);
+        if (m_run.ch == ' ' && is_default_color(m_run.bg, m_mode) && !((m_run.fg | m_run.bg) & (TB_REVERSE | TB_UNDERLINE)) &&
+            ech.size() + 4 < static_cast<size_t>(n))
+        {
+            m_out += ech;
+            return;
+        }
+
+        char              ch[7];
+        const int         len = tb_utf8_unicode_to_char(ch, m_run.ch);
+        const std::string rep = std::format("\x1b[{}b", n - 1);
+
+        // Some terminals (tmux for one) only repeat ASCII characters
+        if (n > 1 && m_run.ch < 0x80 && rep.size() < static_cast<size_t>(len * (n - 1)))
+        {
+            m_out.append(ch, len);
+            m_out += rep;
+        }
+        else
+        {
+            for (int i = 0; i < n; ++i)
+                m_out.append(ch, len);
+        }
+        advance(n);
+    }
+
+    void moveTo(int x, int y)
+    {
+        if (x == m_x && y == m_y)
+            return;
+
+        const std::string cup = (m_compact && x == 0) ? std::format("\x1b[{}H", y + 1)
+                                                      : std::format("\x1b[{};{}H", y + 1, x + 1);
+        m_x = x;
+        m_y = y;
+        if (!m_compact || m_cur_x < 0 || m_cur_y < 0)
+        {
+            m_out += cup;
+            m_cur_x = x;
+            m_cur_y = y;
+            return;
+        }
+
+        std::string rel;
+        const int   dx = x - m_cur_x;
+        const int   dy = y - m_cur_y;
+        if (dy == 1 && x == 0)
+        {
+            rel = "\r\n";
+        }
+        else
+        {
+            if (dy > 0)
+                rel += dy == 1 ? "\x1b[B" : std::format("\x1b[{}B", dy);
+            else if (dy < 0)
+                rel += dy == -1 ? "\x1b[A" : std::format("\x1b[{}A", -dy);
+
+            if (x == 0 && dx != 0)
+                rel += '\r';
+            else if (dx > 0)
+                rel += dx == 1 ? "\x1b[C" : std::format("\x1b[{}C", dx);
+            else if (dx < 0)
+                rel += dx == -1 ? "\x1b[D" : std::format("\x1b[{}D", -dx);
+        }
+
+        m_out += rel.size() < cup.size() ? rel : cup;
+        m_cur_x = x;
+        m_cur_y = y;
+    }
+
+private:
+    void emit(int x, int y, const tb_cell& cell, int w)
+    {
+        moveTo(x, y);
+        setAttr(cell.fg, cell.bg);
+
+        char      ch[7];
+        const int len = tb_utf8_unicode_to_char(ch, cell.ch);
+        m_out.append(ch, len);
+        advance(w);
+    }
+
+    // After printing, the cursor moved along. Reaching the right margin leaves it
+    // in a pending-wrap state that terminals disagree on, so forget it then.
+    void advance(int n)
+    {
+        m_cur_x += n;
+        m_x = m_cur_x;
+        if (m_cur_x >= m_width)
+            m_x = m_y = m_cur_x = m_cur_y = -1;
+    }
+
+    void setAttr(uintattr_t fg, uintattr_t bg)
+    {
+        if (m_attr_known && fg == m_fg && bg == m_bg)
+            return;
+
+        m_full.clear();
+        append_sgr(m_full, fg, bg, m_mode);
+        if (!m_compact || !m_attr_known)
+        {
+            m_out += m_full;
+            remember(fg, bg);
+            return;
+        }
+
+        // Only what changed, unless resetting everything is shorter
+        m_diff.clear();
+        const uintattr_t old_style = (m_fg | (m_bg & TB_REVERSE)) & STYLE_FLAGS;
+        const uintattr_t new_style = (fg | (bg & TB_REVERSE)) & STYLE_FLAGS;
+        const uintattr_t removed   = old_style & ~new_style;
+        const uintattr_t added     = new_style & ~old_style;
+
+        // 22 turns off both bold and dim
+        if (removed & (TB_BOLD | TB_DIM))
+        {
+            m_diff += ";22";
+            if (new_style & TB_BOLD)
+                m_diff += ";1";
+            if (new_style & TB_DIM)
+                m_diff += ";2";
+        }
+        if (removed & TB_ITALIC)
+            m_diff += ";23";
+        if (removed & TB_UNDERLINE)
+            m_diff += ";24";
+        if (removed & TB_BLINK)
+            m_diff += ";25";
+        if (removed & TB_REVERSE)
+            m_diff += ";27";
+        if ((added & TB_BOLD) && !(removed & (TB_BOLD | TB_DIM)))
+            m_diff += ";1";
+        if ((added & TB_DIM) && !(removed & (TB_BOLD | TB_DIM)))
+            m_diff += ";2";
+        if (added & TB_ITALIC)
+            m_diff += ";3";
+        if (added & TB_UNDERLINE)
+            m_diff += ";4";
+        if (added & TB_BLINK)
+            m_diff += ";5";
+        if (added & TB_REVERSE)
+            m_diff += ";7";
+
+        if ((fg & ~STYLE_FLAGS) != (m_fg & ~STYLE_FLAGS))
+            append_color(m_diff, fg, false, m_mode);
+        if ((bg & ~STYLE_FLAGS) != (m_bg & ~STYLE_FLAGS))
+            append_color(m_diff, bg, true, m_mode);
+
+        if (!m_diff.empty() && m_diff.size() + 2 < m_full.size())
+        {
+            m_diff[0] = '[';
+            m_out += '\x1b';
+            m_out += m_diff;
+            m_out += 'm';
+        }
+        else
+        {
+            m_out += m_full;
+        }
+        remember(fg, bg);
+    }
+
+    void remember(uintattr_t fg, uintattr_t bg)
+    {
+        m_attr_known = true;
+        m_fg         = fg;
+        m_bg         = bg;
+    }
+
+    std::string& m_out;
+    int          m_width;
+    bool         m_compact;
+    int          m_mode;
+
+    // Where the next cell is expected (x/y) and where the terminal cursor really is (cur), -1 if unknown
+    int m_x = -1, m_y = -1;
+    int m_cur_x = -1, m_cur_y = -1;
+
+    bool       m_attr_known = false;
+    uintattr_t m_fg = 0, m_bg = 0;
+
+    // Where setAttr() builds the SGRs, in the frame arena so that doesn't allocate
+    std::pmr::string m_full{ frame_arena.resource() };
+    std::pmr::string m_diff{ frame_arena.resource() };
+
+    // Pending run of identical cells
+    tb_cell m_run{};
+    int     m_run_x = 0, m_run_y = 0, m_run_len = 0;
+};
+
+// The diff compares cells as raw bytes, which needs them without padding or EGC fields
+static_assert(sizeof(tb_cell) == sizeof(uint32_t) + 2 * sizeof(uintattr_t), "tb_cell must be tightly packed");
+
+// Index of the first of the `n` cells where `a` and `b` differ, or n if they're all the same.
+// Compares 32 or 16 bytes at a time when built with AVX2 or SSE2, 8 otherwise.
+static int first_mismatch(const tb_cell* a, const tb_cell* b, int n)
+{
+    const auto*  pa    = reinterpret_cast<const unsigned char*>(a);
+    const auto*  pb    = reinterpret_cast<const unsigned char*>(b);
+    const size_t bytes = static_cast<size_t>(n) * sizeof(tb_cell);
+    size_t       i     = 0;
+
+#if defined(__AVX2__)
+    for (; i + 32 <= bytes; i += 32)
+    {
+        const __m256i  va   = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pa + i));
+        const __m256i  vb   = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pb + i));
+        const uint32_t diff = ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)));
+        if (diff)
+            return static_cast<int>((i + std::countr_zero(diff)) / sizeof(tb_cell));
+    }
+#endif
+#if defined(__SSE2__)
+    for (; i + 16 <= bytes; i += 16)
+    {
+        const __m128i  va   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pa + i));
+        const __m128i  vb   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pb + i));
+        const uint32_t diff = ~static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb))) & 0xFFFF;
+        if (diff)
+            return static_cast<int>((i + std::countr_zero(diff)) / sizeof(tb_cell));
+    }
+#endif
+    for (; i + 8 <= bytes; i += 8)
+    {
+        uint64_t wa, wb;
+        memcpy(&wa, pa + i, 8);
+        memcpy(&wb, pb + i, 8);
+        if (wa != wb)
+            break;
+    }
+    while (i < bytes && pa[i] == pb[i])
+        ++i;
+
+    return static_cast<int>(i / sizeof(tb_cell));
+}
+
+// Diff `back` against `front` over the dirty spans, the same way tb_present() does,
+// sending the cells that changed through `enc`
+static void present_cells(std::vector<RowSpan>& dirty, tb_cell* back, tb_cell* front, int width, int height,
+                          AnsiEncoder& enc, DisplayStats& stats)
+{
+    height = std::min(static_cast<int>(dirty.size()), height);
+    for (int y = 0; y < height; ++y)
+    {
+        RowSpan& span = dirty[y];
+        if (span.empty())
+            continue;
+
+        // Widen by one cell on each side, so wide chars overlapping
+        // the edges of the span are diffed as a whole
+        int       x   = std::max(0, span.x0 - 1);
+        const int end = std::min(width - 1, span.x1 + 1);
+        while (x <= end)
+        {
+            // Jump over the cells already on screen. Of those only the last can be a wide char,
+            // since the front holds an invalid cell after each one, so it still goes through the loop
+            // in case it covers the first change.
+            const int same = first_mismatch(&back[y * width + x], &front[y * width + x], end + 1 - x);
+            if (same > 1)
+            {
+                stats.cells_compared += same - 1;
+                x += same - 1;
+            }
+
+            tb_cell& b = back[y * width + x];
+            tb_cell& f = front[y * width + x];
+
+            int w = cell_width(b.ch);
+            if (w < 1)
+                w = 1;  // -1 for invalid codepoints
+
+            ++stats.cells_compared;
+            if (b.ch == f.ch && b.fg == f.fg && b.bg == f.bg)
+            {
+                x += w;
+                continue;
+            }
+
+            ++stats.cells_changed;
+            f = b;
+
+            if (w > 1 && x >= width - (w - 1))
+            {
+                // Not enough room for wide char, send spaces
+                tb_cell space = b;
+                space.ch      = ' ';
+                for (int i = x; i < width; ++i)
+                    enc.put(i, y, space, 1);
+                x += w;
+                continue;
+            }
+
+            enc.put(x, y, b, w);
+
+            // Mark the cells covered by a wide char as invalid in the front buffer,
+            // so a narrow char replacing it later still shows up in the diff
+            for (int i = 1; i < w && x + i < width; ++i)
+            {
+                front[y * width + x + i].ch = static_cast<uint32_t>(-1);
+                front[y * width + x + i].fg = static_cast<uintattr_t>(-1);
+                front[y * width + x + i].bg = static_cast<uintattr_t>(-1);
+            }
+            x += w;
+        }
+
+        span = RowSpan{};
+    }
+    enc.flush();
+}
+
+// Scroll rows top..bottom of `front` down by n like the terminal does, and append the escapes doing it to `out`.
+// The rows scrolled in come out blank with the default colors, since the SGR is reset first.
+static void scroll_rows(std::string& out, tb_cell* front, int width, int top, int bottom, int n)
+{
+    // Set the scroll region (which homes the cursor), reverse index n times from its top line, reset the region
+    std::format_to(std::back_inserter(out), "\x1b[0m\x1b[{};{}r\x1b[{}H", top + 1, bottom + 1, top + 1);
+    for (int i = 0; i < n; ++i)
+        out += "\x1bM";
+    out += "\x1b[r";
+
+    std::copy_backward(front + top * width, front + (bottom - n + 1) * width, front + (bottom + 1) * width);
+    std::fill(front + top * width, front + (top + n) * width, blank_cell());
+}
+
+bool TermboxBackend::scrollRows(int top, int bottom, int n)
+{
+    if (!ready() || top < 0 || bottom >= global.front.height || n <= 0 || n > bottom - top)
+        return false;
+
+    scroll_rows(m_scroll, global.front.cells, global.front.width, top, bottom, n);
+    return true;
+}
+
+void TermboxBackend::present(std::vector<RowSpan>& dirty, DisplayStats& stats)
+{
+    const bool async   = settings.general.async_output;
+    const bool resized = global.width != m_sent_width || global.height != m_sent_height;
+    if (resized)
+    {
+        // Everything is dirty anyway after a resize
+        m_held.clear();
+        m_has_held = false;
+        m_scroll.clear();
+    }
+
+    if (async && !resized)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_busy || !m_pending.empty())
+        {
+            // Still writing, keep the changes for the next present
+            m_held.resize(dirty.size());
+            for (size_t y = 0; y < dirty.size(); ++y)
+            {
+                if (!dirty[y].empty())
+                    m_held[y].add(dirty[y].x0, dirty[y].x1);
+                dirty[y] = RowSpan{};
+            }
+            m_has_held = true;
+            ++stats.frames_held;
+            return;
+        }
+    }
+    else
+    {
+        // Don't write over a frame still on its way
+        waitWriterIdle();
+    }
+
+    if (m_has_held)
+    {
+        for (size_t y = 0; y < std::min(dirty.size(), m_held.size()); ++y)
+            if (!m_held[y].empty())
+                dirty[y].add(m_held[y].x0, m_held[y].x1);
+        m_held.clear();
+        m_has_held = false;
+    }
+
+    m_out.clear();
+
+    // Synchronized output (DEC mode 2026): the terminal holds off rendering
+    // until the end marker, so the frame shows up atomically.
+    // Terminals that don't know the mode just ignore it.
+    m_out += SYNC_OUTPUT_BEGIN;
+
+    // termbox clears the screen on resize, but a frame for the old size
+    // might have been written by the writer thread after that
+    const bool clear = resized && m_writer.joinable();
+    if (clear)
+        m_out += "\x1b[0m\x1b[2J";
+
+    const bool scrolled = !m_scroll.empty();
+    m_out += m_scroll;
+    m_scroll.clear();
+
+    AnsiEncoder enc(m_out, global.front.width, settings.general.compact_output, global.output_mode);
+    present_cells(dirty, global.back.cells, global.front.cells, global.front.width, global.front.height, enc, stats);
+    m_sent_width  = global.width;
+    m_sent_height = global.height;
+    if (stats.cells_changed == 0 && !clear && !scrolled)
+        return;
+
+    if (global.cursor_x >= 0 && global.cursor_y >= 0)
+        enc.moveTo(global.cursor_x, global.cursor_y);
+
+    m_out += SYNC_OUTPUT_END;
+    stats.bytes_written = m_out.size();
+
+    if (!async)
+    {
+        writeFrame(m_out);
+        return;
+    }
+
+    if (!m_writer.joinable())
+        m_writer = std::thread(&TermboxBackend::writerLoop, this);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending.swap(m_out);
+    m_cv.notify_all();
+}
+
+void TermboxBackend::writeFrame(const std::string& frame)
+{
+    const auto start = std::chrono::steady_clock::now();
+    size_t     done  = 0;
+    while (done < frame.size())
+    {
+        const ssize_t n = write(global.wfd, frame.data() + done, frame.size() - done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        done += n;
+    }
+
+    // Writes only block once the tty can't keep up, so over enough bytes
+    // the time spent in them tells how fast the link really is
+    m_window_bytes += frame.size();
+    m_window_secs += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (m_window_bytes < SLOW_OUTPUT_WINDOW)
+        return;
+
+    if (m_window_bytes / m_window_secs < SLOW_OUTPUT_RATE)
+    {
+        if (m_preferred_mode == TB_OUTPUT_TRUECOLOR)
+            m_preferred_mode = TB_OUTPUT_256;
+        else if (m_preferred_mode == TB_OUTPUT_256)
+            m_preferred_mode = TB_OUTPUT_NORMAL;
+    }
+    m_window_bytes = 0;
+    m_window_secs  = 0;
+}
+
+void TermboxBackend::writerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;)
+    {
+        m_cv.wait(lock, [this] { return m_stop || !m_pending.empty(); });
+        if (m_stop)
+            break;
+
+        m_writing.swap(m_pending);
+        m_pending.clear();
+        m_busy = true;
+
+        lock.unlock();
+        writeFrame(m_writing);
+        lock.lock();
+
+        m_busy = false;
+        m_cv.notify_all();
+    }
+}
+
+void TermboxBackend::waitWriterIdle()
+{
+    if (!m_writer.joinable())
+        return;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [this] { return !m_busy && m_pending.empty(); });
+}
+
+void TermboxBackend::stopWriter()
+{
+    if (!m_writer.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    m_writer.join();
+
+    m_stop = false;
+    m_pending.clear();
+}
+
+// -------------------------------------
+// Headless
+// -------------------------------------
+
+bool HeadlessBackend::init()
+{
+    resize(m_width, m_height);
+    m_ready = true;
+    return true;
+}
+
+void HeadlessBackend::resize(int width, int height)
+{
+    m_width  = std::max(0, width);
+    m_height = std::max(0, height);
+    m_back.assign(m_width * m_height, blank_cell());
+    m_front.assign(m_width * m_height, blank_cell());
+    m_scroll.clear();
+}
+
+bool HeadlessBackend::scrollRows(int top, int bottom, int n)
+{
+    if (!m_ready || top < 0 || bottom >= m_height || n <= 0 || n > bottom - top)
+        return false;
+
+    scroll_rows(m_scroll, m_front.data(), m_width, top, bottom, n);
+    return true;
+}
+
+void HeadlessBackend::present(std::vector<RowSpan>& dirty, DisplayStats& stats)
+{
+    m_out = m_scroll;
+    m_scroll.clear();
+    AnsiEncoder enc(m_out, m_width, settings.general.compact_output, m_output_mode);
+    present_cells(dirty, m_back.data(), m_front.data(), m_width, m_height, enc, stats);
+    stats.bytes_written = m_out.size();
+}
+
+// Append the UTF-8 of `cell` to `out`, returns how many columns it covers
+static int append_cell(std::string& out, const tb_cell& cell)
+{
+    char buf[7];
+    tb_utf8_unicode_to_char(buf, cell.ch ? cell.ch : ' ');
+    out += buf;
+
+    return std::max(1, cell_width(cell.ch));
+}
+
+std::string HeadlessBackend::dumpText() const
+{
+    std::string out;
+    for (int y = 0; y < m_height; ++y)
+    {
+        std::string line;
+        for (int x = 0; x < m_width;)
+            x += append_cell(line, m_front[y * m_width + x]);
+
+        line.erase(line.find_last_not_of(' ') + 1);
+        out += line;
+        out += '\n';
+    }
+    return out;
+}
+
+std::string HeadlessBackend::dumpAnsi() const
+{
+    std::string out;
+    for (int y = 0; y < m_height; ++y)
+    {
+        uintattr_t last_fg = TB_DEFAULT;
+        uintattr_t last_bg = TB_DEFAULT;
+        for (int x = 0; x < m_width;)
+        {
+            const tb_cell& cell = m_front[y * m_width + x];
+            if (cell.fg != last_fg || cell.bg != last_bg)
+            {
+                append_sgr(out, cell.fg, cell.bg, m_output_mode);
+                last_fg = cell.fg;
+                last_bg = cell.bg;
+            }
+            x += append_cell(out, cell);
+        }
+
+        out += "\x1b[0m\n";
+    }
+    return out;
+}
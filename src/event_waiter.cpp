@@ -0,0 +1,140 @@
+#include "event_waiter.hpp"
+
+#include <algorithm>
+#include <cerrno>
+
+#include "frame_profiler.hpp"
+#include "terminal_display.hpp"
+
+#ifdef __linux__
+#  include <sys/epoll.h>
+#  include <sys/timerfd.h>
+#  include <unistd.h>
+#endif
+
+EventWaiter::~EventWaiter()
+{
+    closeFds();
+}
+
+bool EventWaiter::init()
+{
+#ifdef __linux__
+    int tty_fd = -1, resize_fd = -1;
+    if (tb_get_fds(&tty_fd, &resize_fd) != TB_OK)
+        return false;
+
+    // GameClock is CLOCK_MONOTONIC, the timer takes its deadlines as they are
+    m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    m_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (m_epoll_fd < 0 || m_timer_fd < 0)
+    {
+        closeFds();
+        return false;
+    }
+
+    for (const int fd : { tty_fd, resize_fd, m_timer_fd })
+    {
+        epoll_event event{};
+        event.events  = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0)
+        {
+            closeFds();
+            return false;
+        }
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void EventWaiter::closeFds()
+{
+#ifdef __linux__
+    if (m_timer_fd >= 0)
+        close(m_timer_fd);
+    if (m_epoll_fd >= 0)
+        close(m_epoll_fd);
+#endif
+    m_timer_fd  = -1;
+    m_epoll_fd  = -1;
+    m_timer_set = false;
+}
+
+bool EventWaiter::wait(tb_event& ev, GameClock::time_point deadline)
+{
+    // Whatever termbox already has buffered, or the tty has ready, comes first
+    if (display.peekEvent(ev, 0))
+        return true;
+
+#ifdef __linux__
+    if (m_epoll_fd >= 0 && m_timer_fd >= 0)
+    {
+        if (deadline != GameClock::time_point::max())
+        {
+            // An absolute deadline: a wake-up for input in between doesn't push it back.
+            // A zero it_value disarms the timer, so a deadline already gone is made 1ns past the epoch
+            const auto      ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch());
+            const long long t = std::max<long long>(ns.count(), 1);
+
+            itimerspec spec{};
+            spec.it_value.tv_sec  = t / 1'000'000'000;
+            spec.it_value.tv_nsec = t % 1'000'000'000;
+            m_timer_set           = timerfd_settime(m_timer_fd, TFD_TIMER_ABSTIME, &spec, nullptr) == 0;
+
+            // Without the timer armed the epoll would wait past the deadline, the fallback doesn't
+            if (!m_timer_set)
+                closeFds();
+        }
+        else if (m_timer_set)
+        {
+            const itimerspec disarm{};
+            timerfd_settime(m_timer_fd, 0, &disarm, nullptr);
+            m_timer_set = false;
+        }
+
+        while (m_epoll_fd >= 0)
+        {
+            epoll_event events[3];
+            const int   n = epoll_wait(m_epoll_fd, events, 3, -1);
+            if (n < 0)
+            {
+                // SIGWINCH interrupts the wait, termbox's handler has written to its pipe meanwhile.
+                // Anything else and the epoll is no good, the fallback takes over
+                if (errno != EINTR)
+                    closeFds();
+                continue;
+            }
+
+            bool expired = false, input = false;
+            for (int i = 0; i < n; ++i)
+                (events[i].data.fd == m_timer_fd ? expired : input) = true;
+
+            // Input wins over a deadline due at the same time, the next wait sees the deadline gone anyway
+            if (input && display.peekEvent(ev, 0))
+                return true;
+
+            if (expired)
+            {
+                uint64_t expirations = 0;
+                (void)read(m_timer_fd, &expirations, sizeof(expirations));
+                m_timer_set = false;
+                profiler.record(ProfilePhase::TimerLate, GameClock::now() - deadline);
+                return false;
+            }
+
+            // Only part of an escape sequence so far, wait for the rest
+        }
+    }
+#endif
+
+    int timeout = -1;
+    if (deadline != GameClock::time_point::max())
+    {
+        const auto wait = std::chrono::ceil<std::chrono::milliseconds>(deadline - GameClock::now());
+        timeout         = static_cast<int>(std::max<GameClock::rep>(wait.count(), 0));
+    }
+    return display.peekEvent(ev, timeout);
+}
@@ -0,0 +1,62 @@
+#include "frame_governor.hpp"
+
+#include <algorithm>
+
+void FrameGovernor::reset(GameClock::time_point now)
+{
+    m_last        = now;
+    m_ticking     = true;
+    m_owed        = GameClock::duration::zero();
+    m_next_render = now;
+    m_dirty       = true;
+    m_stats       = LoopStats{};
+    m_stats.since = now;
+}
+
+int FrameGovernor::ticksDue(GameClock::time_point now, GameClock::duration tick, int max_skip)
+{
+    // Time spent not ticking (the scene paused) isn't owed once it ticks again
+    const GameClock::duration elapsed = m_ticking ? now - m_last : GameClock::duration::zero();
+    m_last                            = now;
+    m_ticking                         = tick > GameClock::duration::zero();
+    if (!m_ticking)
+    {
+        m_owed = GameClock::duration::zero();
+        return 0;
+    }
+
+    m_owed += elapsed;
+    const auto due   = m_owed / tick;
+    const auto ticks = std::min<GameClock::rep>(due, max_skip + 1);
+
+    // Past the catch-up limit: whatever is left over now is forgotten, only the partial tick is kept
+    m_owed = due > ticks ? m_owed % tick : m_owed - ticks * tick;
+    m_stats.ticks += ticks;
+    if (ticks > 0)
+        m_dirty = true;
+    return static_cast<int>(ticks);
+}
+
+bool FrameGovernor::shouldRender(GameClock::time_point now) const
+{
+    return m_dirty && now >= m_next_render;
+}
+
+void FrameGovernor::rendered(GameClock::time_point start)
+{
+    m_next_render = start + DISPLAY_INTERVAL;
+    m_dirty       = false;
+    ++m_stats.renders;
+}
+
+GameClock::time_point FrameGovernor::nextWake(GameClock::time_point now, GameClock::duration tick,
+                                              GameClock::time_point wake) const
+{
+    GameClock::time_point next = wake;
+    if (tick > GameClock::duration::zero())
+        next = std::min(next, std::max(m_last + tick - m_owed, now));
+    if (m_dirty)
+        next = std::min(next, std::max(m_next_render, now));
+
+    return next;
+}
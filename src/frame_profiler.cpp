@@ -0,0 +1,153 @@
+#include "frame_profiler.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <limits>
+
+#include "terminal_display.hpp"
+
+static constexpr const char* PHASE_NAMES[] = { "input", "handle_input", "render", "footer", "present", "timer late" };
+static_assert(std::size(PHASE_NAMES) == static_cast<size_t>(ProfilePhase::COUNT));
+
+// Bucket of a sample of `us`
+static size_t bucket_of(uint32_t us)
+{
+    if (us < 4)
+        return us;
+
+    // The top 3 bits: the power of 2, and which quarter of it
+    const int    exp    = std::bit_width(us) - 1;
+    const size_t bucket = (exp - 1) * 4 + ((us >> (exp - 2)) & 3);
+    return std::min(bucket, FrameProfiler::BUCKETS - 1);
+}
+
+// Lowest sample that lands in `bucket`
+static uint64_t bucket_floor(size_t bucket)
+{
+    if (bucket < 4)
+        return bucket;
+
+    return static_cast<uint64_t>(4 + bucket % 4) << (bucket / 4 - 1);
+}
+
+// Highest, the last bucket has no upper bound
+static uint64_t bucket_ceil(size_t bucket)
+{
+    return bucket + 1 < FrameProfiler::BUCKETS ? bucket_floor(bucket + 1) - 1 : std::numeric_limits<uint32_t>::max();
+}
+
+void FrameProfiler::record(ProfilePhase phase, GameClock::duration d)
+{
+    const auto     count = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+    const uint32_t us    = static_cast<uint32_t>(
+        std::clamp<GameClock::rep>(count, 0, std::numeric_limits<uint32_t>::max()));
+
+    Samples& s = m_phases[static_cast<size_t>(phase)];
+    s.ring[s.count % RING_SIZE] = us;
+    ++s.histogram[bucket_of(us)];
+    ++s.count;
+    s.total += us;
+    s.max = std::max(s.max, us);
+}
+
+void FrameProfiler::draw()
+{
+    if (!m_overlay)
+        return;
+
+    static constexpr int WIDTH  = 40;
+    static constexpr int HEIGHT = static_cast<int>(ProfilePhase::COUNT) + 4;
+
+    const int x = std::max(0, display.getWidth() - WIDTH);
+    display.resetFont();
+    display.setTextColor(TB_WHITE);
+    display.setTextBgColor(TB_BLACK);
+    display.drawFilledRect(x, 0, WIDTH, HEIGHT, ' ');
+
+    display.setCursor(x + 1, 0);
+    display.print("{:<13}{:>8}{:>8}{:>8}", "phase (ms)", "p50", "p99", "max");
+
+    // Rolling numbers: over what's in the ring, sorted only here, when the overlay is drawn
+    std::array<uint32_t, RING_SIZE> sorted;
+    for (size_t i = 0; i < m_phases.size(); ++i)
+    {
+        const Samples& s = m_phases[i];
+        const size_t   n = std::min<uint64_t>(s.count, RING_SIZE);
+        std::copy_n(s.ring.begin(), n, sorted.begin());
+        std::sort(sorted.begin(), sorted.begin() + n);
+
+        const auto ms = [](uint32_t us) { return us / 1000.0; };
+        display.setCursor(x + 1, 1 + static_cast<int>(i));
+        if (n == 0)
+            display.print("{:<13}{:>8}{:>8}{:>8}", PHASE_NAMES[i], "-", "-", "-");
+        else
+            display.print("{:<13}{:>8.2f}{:>8.2f}{:>8.2f}", PHASE_NAMES[i], ms(sorted[n / 2]), ms(sorted[n * 99 / 100]),
+                          ms(sorted[n - 1]));
+    }
+
+    // What the last present sent out
+    const DisplayStats& stats = display.getStats();
+    display.setCursor(x + 1, HEIGHT - 2);
+    display.print("cells changed {:>8}", stats.cells_changed);
+    display.setCursor(x + 1, HEIGHT - 1);
+    display.print("bytes flushed {:>8}", stats.bytes_written);
+    display.resetColors();
+}
+
+bool FrameProfiler::dump(const std::string& path) const
+{
+    if (!m_shown || path.empty())
+        return true;
+
+    FILE* f = fopen(path.c_str(), "w");
+    if (!f)
+        return false;
+
+    for (size_t i = 0; i < m_phases.size(); ++i)
+    {
+        const Samples& s = m_phases[i];
+        fprintf(f, "%s: %llu samples", PHASE_NAMES[i], static_cast<unsigned long long>(s.count));
+        if (s.count == 0)
+        {
+            fputs("\n\n", f);
+            continue;
+        }
+
+        // Percentiles of the whole run, as the upper bound of the bucket they fall in
+        uint64_t p50 = 0, p99 = 0, seen = 0;
+        bool     has_p50 = false, has_p99 = false;
+        for (size_t b = 0; b < BUCKETS && !has_p99; ++b)
+        {
+            seen += s.histogram[b];
+            if (!has_p50 && seen * 2 >= s.count)
+            {
+                p50     = std::min<uint64_t>(bucket_ceil(b), s.max);
+                has_p50 = true;
+            }
+            if (seen * 100 >= s.count * 99)
+            {
+                p99     = std::min<uint64_t>(bucket_ceil(b), s.max);
+                has_p99 = true;
+            }
+        }
+        fprintf(f, ", mean %lluus, p50 <=%lluus, p99 <=%lluus, max %uus\n",
+                static_cast<unsigned long long>(s.total / s.count), static_cast<unsigned long long>(p50),
+                static_cast<unsigned long long>(p99), s.max);
+
+        for (size_t b = 0; b < BUCKETS; ++b)
+        {
+            if (s.histogram[b] == 0)
+                continue;
+            if (b + 1 < BUCKETS)
+                fprintf(f, "  %10llu - %10llu us  %llu\n", static_cast<unsigned long long>(bucket_floor(b)),
+                        static_cast<unsigned long long>(bucket_ceil(b)), static_cast<unsigned long long>(s.histogram[b]));
+            else
+                fprintf(f, "  %10llu+             us  %llu\n", static_cast<unsigned long long>(bucket_floor(b)),
+                        static_cast<unsigned long long>(s.histogram[b]));
+        }
+        fputc('\n', f);
+    }
+
+    return fclose(f) == 0;
+}
@@ -1,8 +1,10 @@
 #include "games/2048.hpp"
 
 #include <algorithm>
+#include <iterator>
 #include <random>
 #include <string>
+#include <vector>
 
 // Border characters
 static uint32_t CH_BORDER_H  = U'═';
@@ -37,18 +39,21 @@ Result<> Game2048::on_begin()
     return Ok();
 }
 
-void Game2048::init_game()
+void Game2048::on_resize(int width, int height)
 {
     // Calculate cell size based on terminal dimensions
-    int max_cell_w = (display.getWidth() / 2) / GRID_SIZE;
-    int max_cell_h = (display.getHeight() / 2) / GRID_SIZE;
+    int max_cell_w = (width / 2) / GRID_SIZE;
+    int max_cell_h = (height / 2) / GRID_SIZE;
     m_cell_w       = std::max(3, std::min(max_cell_w, max_cell_h));
     m_cell_h       = m_cell_w;
 
     // Center the grid
-    m_grid_x = (display.getWidth() - (GRID_SIZE * m_cell_w)) / 2;
-    m_grid_y = (display.getHeight() - (GRID_SIZE * m_cell_h)) / 2;
+    m_grid_x = (width - (GRID_SIZE * m_cell_w)) / 2;
+    m_grid_y = (height - (GRID_SIZE * m_cell_h)) / 2;
+}
 
+void Game2048::init_game()
+{
     if (settings.general.utf8)
     {
         CH_BORDER_H  = U'═';
@@ -68,6 +73,9 @@ void Game2048::init_game()
         CH_CORNER_BR = '+';
     }
 
+    // Glyphs might have changed
+    m_chrome.invalidate();
+
     m_grid      = {};
     m_score     = 0;
     m_game_over = false;
@@ -80,10 +88,9 @@ void Game2048::init_game()
 
 void Game2048::add_new_tile()
 {
-    static std::mt19937 rng{ std::random_device{}() };
-
     // Find all empty cells
-    std::vector<std::pair<int, int>> empty_cells;
+    std::pmr::vector<std::pair<int, int>> empty_cells(frame_arena.resource());
+    empty_cells.reserve(GRID_SIZE * GRID_SIZE);
     for_2d(GRID_SIZE, GRID_SIZE, [&](int row, int col) {
         if (m_grid[row][col] == 0)
             empty_cells.emplace_back(row, col);
@@ -94,11 +101,11 @@ void Game2048::add_new_tile()
 
     // Randomly choose an empty cell
     std::uniform_int_distribution<int> dist(0, empty_cells.size() - 1);
-    auto [row, col] = empty_cells[dist(rng)];
+    auto [row, col] = empty_cells[dist(m_rng)];
 
     // 90% chance for 2, 10% chance for 4
     std::uniform_int_distribution<int> value_dist(0, 9);
-    m_grid[row][col] = (value_dist(rng) == 0) ? 4 : 2;
+    m_grid[row][col] = (value_dist(m_rng) == 0) ? 4 : 2;
 }
 
 bool Game2048::move(Direction dir)
@@ -110,7 +117,8 @@ bool Game2048::move(Direction dir)
     for (int i = 0; i < GRID_SIZE; ++i)
     {
         // Collect non-zero values along the line
-        std::vector<int> line;
+        std::pmr::vector<int> line(frame_arena.resource());
+        line.reserve(GRID_SIZE);
         for (int j = 0; j < GRID_SIZE; ++j)
         {
             // When reversed, walk the line back-to-front during collection
@@ -201,11 +209,12 @@ uintattr_t Game2048::get_color_for_value(int value) const
     }
 }
 
-std::string Game2048::format_number(int value) const
+std::pmr::string Game2048::format_number(int value) const
 {
-    if (value == 0)
-        return "";
-    return std::format("{:^{}}", value, m_cell_w);
+    std::pmr::string str(frame_arena.resource());
+    if (value != 0)
+        std::format_to(std::back_inserter(str), "{:^{}}", value, m_cell_w);
+    return str;
 }
 
 void Game2048::render()
@@ -213,7 +222,13 @@ void Game2048::render()
     if (!playback.isMusicPlaying())
         playback.playMusic(Game2048Sounds::BGM);
 
-    draw_border();
+    if (m_chrome.stale())
+    {
+        display.beginLayer(m_chrome);
+        draw_border();
+        display.endLayer();
+    }
+
     draw_grid();
     draw_hud();
 
@@ -233,20 +248,16 @@ void Game2048::draw_border()
     int y2 = m_grid_y + (GRID_SIZE * m_cell_h);
 
     // Top border
-    for (int x = x1 + 1; x < x2; ++x)
-        display.drawPixel(x, y1, CH_BORDER_H);
+    display.drawFastHLine(x1 + 1, y1, x2 - x1 - 1, CH_BORDER_H);
 
     // Bottom border
-    for (int x = x1 + 1; x < x2; ++x)
-        display.drawPixel(x, y2, CH_BORDER_H);
+    display.drawFastHLine(x1 + 1, y2, x2 - x1 - 1, CH_BORDER_H);
 
     // Left border
-    for (int y = y1 + 1; y < y2; ++y)
-        display.drawPixel(x1, y, CH_BORDER_V);
+    display.drawFastVLine(x1, y1 + 1, y2 - y1 - 1, CH_BORDER_V);
 
     // Right border
-    for (int y = y1 + 1; y < y2; ++y)
-        display.drawPixel(x2, y, CH_BORDER_V);
+    display.drawFastVLine(x2, y1 + 1, y2 - y1 - 1, CH_BORDER_V);
 
     // Corners
     display.drawPixel(x1, y1, CH_CORNER_TL);
@@ -272,7 +283,7 @@ void Game2048::draw_cell(int row, int col, int value)
     // Value
     if (value != 0)
     {
-        const std::string& str = format_number(value);
+        const std::pmr::string& str = format_number(value);
         display.setTextColor(TB_BLACK | TB_BOLD);
         display.setCursor(x + (m_cell_w / 2) - (str.length() / 2), y + (m_cell_h / 2));
         display.print(str);
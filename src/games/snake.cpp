@@ -27,6 +27,20 @@ static constexpr uintattr_t COL_PAUSED     = TB_YELLOW | TB_BOLD;
 static constexpr int SPEED_STEP_MS   = 10;  // ms reduction per milestone
 static constexpr int SPEED_MILESTONE = 5;   // points between speed-ups
 
+// Turns that can wait for their tick, more presses than that before the snake moves get ignored
+static constexpr size_t MAX_QUEUED_TURNS = 3;
+
+static SnakeDir opposite(SnakeDir dir)
+{
+    switch (dir)
+    {
+        case SnakeDir::Up:   return SnakeDir::Down;
+        case SnakeDir::Down: return SnakeDir::Up;
+        case SnakeDir::Left: return SnakeDir::Right;
+        default:             return SnakeDir::Left;
+    }
+}
+
 Result<> SnakeGame::on_begin()
 {
     set_footer("Arrows: Move | P: Pause | ESC: Back");
@@ -37,9 +51,13 @@ Result<> SnakeGame::on_begin()
 
 void SnakeGame::render()
 {
-    update();
+    if (m_chrome.stale())
+    {
+        display.beginLayer(m_chrome);
+        draw_border();
+        display.endLayer();
+    }
 
-    draw_border();
     draw_hud();
 
     if (m_dead)
@@ -83,41 +101,80 @@ SceneResult SnakeGame::handle_input(uint32_t key)
         return ScenesGame::Snake;
     }
 
-    // Direction (prevent 180-degree reversal)
+    SnakeDir dir;
     switch (key)
     {
-        case TB_KEY_ARROW_UP:
-            if (m_dir != SnakeDir::Down)
-                m_next_dir = SnakeDir::Up;
-            break;
-        case TB_KEY_ARROW_DOWN:
-            if (m_dir != SnakeDir::Up)
-                m_next_dir = SnakeDir::Down;
-            break;
-        case TB_KEY_ARROW_LEFT:
-            if (m_dir != SnakeDir::Right)
-                m_next_dir = SnakeDir::Left;
-            break;
-        case TB_KEY_ARROW_RIGHT:
-            if (m_dir != SnakeDir::Left)
-                m_next_dir = SnakeDir::Right;
-            break;
-        default: break;
+        case TB_KEY_ARROW_UP:    dir = SnakeDir::Up; break;
+        case TB_KEY_ARROW_DOWN:  dir = SnakeDir::Down; break;
+        case TB_KEY_ARROW_LEFT:  dir = SnakeDir::Left; break;
+        case TB_KEY_ARROW_RIGHT: dir = SnakeDir::Right; break;
+        default:                 return ScenesGame::Snake;
     }
 
+    // Queue the turn for the next tick, after the ones already pressed.
+    // Going the same way or reversing (180 degrees) from where it'll be heading by then does nothing.
+    const SnakeDir last = m_turns.empty() ? m_dir : m_turns.back();
+    if (dir != last && dir != opposite(last) && m_turns.size() < MAX_QUEUED_TURNS)
+        m_turns.push_back(dir);
+
     return ScenesGame::Snake;
 }
 
-void SnakeGame::init_game()
+void SnakeGame::on_resize(int width, int height)
 {
+    const int old_x = m_board_x + 1;
+    const int old_y = m_board_y + 1;
+
     // ~75% of the terminal, centred.
     // Inner playfield is (board_w-2) × (board_h-2) after the border.
-    m_board_w = std::max(10, (display.getWidth() * 3) / 4);
-    m_board_h = std::max(8, (display.getHeight() * 3) / 4);
+    m_board_w = std::max(10, (width * 3) / 4);
+    m_board_h = std::max(8, (height * 3) / 4);
+
+    m_board_x = (width - m_board_w) / 2;
+    m_board_y = (height - m_board_h) / 2;
+
+    // Nothing to carry over before the first round, or once it's over (R starts the next one)
+    if (m_snake.empty() || m_dead)
+        return;
+
+    const int inner_x0 = m_board_x + 1;
+    const int inner_y0 = m_board_y + 1;
+    const int inner_x1 = m_board_x + m_board_w - 2;
+    const int inner_y1 = m_board_y + m_board_h - 2;
 
-    m_board_x = (display.getWidth() - m_board_w) / 2;
-    m_board_y = (display.getHeight() - m_board_h) / 2;
+    // Carry the game over to the new playfield, the snake as a whole so it keeps its shape:
+    // where it was from the top left, then pushed back in if the playfield shrank past it.
+    // If it doesn't fit at all anymore, the round starts over
+    const auto [left, right] =
+        std::minmax_element(m_snake.begin(), m_snake.end(), [](const Point& a, const Point& b) { return a.x < b.x; });
+    const auto [top, bottom] =
+        std::minmax_element(m_snake.begin(), m_snake.end(), [](const Point& a, const Point& b) { return a.y < b.y; });
+    if (right->x - left->x > inner_x1 - inner_x0 || bottom->y - top->y > inner_y1 - inner_y0)
+    {
+        init_game();
+        return;
+    }
+
+    const int dx = std::clamp(inner_x0 - old_x, inner_x0 - left->x, inner_x1 - right->x);
+    const int dy = std::clamp(inner_y0 - old_y, inner_y0 - top->y, inner_y1 - bottom->y);
+    for (Point& p : m_snake)
+    {
+        p.x += dx;
+        p.y += dy;
+    }
+
+    // It might be right against a wall now, let the player see where it went first
+    if (dx != inner_x0 - old_x || dy != inner_y0 - old_y)
+        m_paused = true;
+
+    m_food.x = std::clamp(m_food.x + inner_x0 - old_x, inner_x0, inner_x1);
+    m_food.y = std::clamp(m_food.y + inner_y0 - old_y, inner_y0, inner_y1);
+    if (std::find(m_snake.begin(), m_snake.end(), m_food) != m_snake.end())
+        spawn_food();
+}
 
+void SnakeGame::init_game()
+{
     if (settings.general.utf8)
     {
         CH_SNAKE_HEAD = U'◉';
@@ -143,12 +200,15 @@ void SnakeGame::init_game()
         CH_CORNER_BR  = '+';
     }
 
+    // Glyphs might have changed
+    m_chrome.invalidate();
+
     m_snake.clear();
     m_score    = 0;
     m_dead     = false;
     m_paused   = false;
     m_dir      = SnakeDir::Right;
-    m_next_dir = SnakeDir::Right;
+    m_turns.clear();
     m_speed_ms = static_cast<int>(settings.game_snake.snake_max_speed);
 
     // Start with a 3-segment snake centred in the playfield
@@ -161,12 +221,16 @@ void SnakeGame::init_game()
     spawn_food();
 }
 
-void SnakeGame::update()
+void SnakeGame::update(GameClock::duration /*dt*/)
 {
     if (m_dead || m_paused)
         return;
 
-    m_dir = m_next_dir;
+    if (!m_turns.empty())
+    {
+        m_dir = m_turns.front();
+        m_turns.pop_front();
+    }
 
     // Compute new head position
     Point head = m_snake.front();
@@ -278,18 +342,12 @@ void SnakeGame::draw_border()
     const int h = m_board_h;
 
     // Horizontal edges
-    for (int col = x + 1; col < x + w - 1; ++col)
-    {
-        display.drawPixel(col, y, CH_BORDER_H);
-        display.drawPixel(col, y + h - 1, CH_BORDER_H);
-    }
+    display.drawFastHLine(x + 1, y, w - 2, CH_BORDER_H);
+    display.drawFastHLine(x + 1, y + h - 1, w - 2, CH_BORDER_H);
 
     // Vertical edges
-    for (int row = y + 1; row < y + h - 1; ++row)
-    {
-        display.drawPixel(x, row, CH_BORDER_V);
-        display.drawPixel(x + w - 1, row, CH_BORDER_V);
-    }
+    display.drawFastVLine(x, y + 1, h - 2, CH_BORDER_V);
+    display.drawFastVLine(x + w - 1, y + 1, h - 2, CH_BORDER_V);
 
     // Corners
     display.drawPixel(x, y, CH_CORNER_TL);
@@ -32,6 +32,11 @@ static constexpr uintattr_t COLOR_HUD      = TB_CYAN | TB_BOLD;
 static constexpr uintattr_t COLOR_GAMEOVER = TB_RED | TB_BOLD;
 static constexpr uintattr_t COLOR_PAUSED   = TB_YELLOW | TB_BOLD;
 
+// Auto-repeat of a held move key, when the terminal reports key releases:
+// first repeat after the delay, then one every interval, instead of the tty's own (usually ~500ms then 30/s)
+static constexpr std::chrono::milliseconds REPEAT_DELAY{ 170 };
+static constexpr std::chrono::milliseconds REPEAT_INTERVAL{ 50 };
+
 // Scoring
 static constexpr int SCORES[] = { 0, 40, 100, 300, 1200 };  // 1, 2, 3, 4 lines
 
@@ -43,15 +48,12 @@ Result<> TetrisGame::on_begin()
     return Ok();
 }
 
-void TetrisGame::init_game()
+void TetrisGame::on_resize(int width, int height)
 {
-    m_grid.assign(GRID_HEIGHT, std::vector<uint32_t>(GRID_WIDTH, 0));
-
     // Choose cell size based on terminal dimensions
     // We need at least GRID_WIDTH * cell_size width and GRID_HEIGHT * cell_size height
-    m_cell_size         = 1;
-    int max_cell_width  = display.getWidth() / (GRID_WIDTH + NEXT_SIZE + 4);  // +4 for padding
-    int max_cell_height = display.getHeight() / (GRID_HEIGHT + 2);            // +2 for border
+    int max_cell_width  = width / (GRID_WIDTH + NEXT_SIZE + 4);  // +4 for padding
+    int max_cell_height = height / (GRID_HEIGHT + 2);            // +2 for border
 
     m_cell_size = std::max(1, std::min(max_cell_width, max_cell_height));
 
@@ -60,8 +62,17 @@ void TetrisGame::init_game()
     m_grid_h = GRID_HEIGHT * m_cell_size;
 
     // Center the grid
-    m_grid_x = (display.getWidth() - m_grid_w - NEXT_SIZE * m_cell_size - 8) / 2;
-    m_grid_y = (display.getHeight() - m_grid_h) / 2;
+    m_grid_x = (width - m_grid_w - NEXT_SIZE * m_cell_size - 8) / 2;
+    m_grid_y = (height - m_grid_h) / 2;
+
+    // What's on screen is in the old layout, nothing there to scroll
+    m_cleared_rows.clear();
+}
+
+void TetrisGame::init_game()
+{
+    m_grid.assign(GRID_HEIGHT, std::vector<uint32_t>(GRID_WIDTH, 0));
+    m_cleared_rows.clear();
 
     if (settings.general.utf8)
     {
@@ -84,13 +95,16 @@ void TetrisGame::init_game()
         CH_BLOCK     = '#';
     }
 
+    // Glyphs might have changed
+    m_chrome.invalidate();
+
     m_score         = 0;
     m_lines_cleared = 0;
     m_level         = 0;
     m_game_over     = false;
     m_paused        = false;
-    m_fall_timer    = 0;
-    m_last_update   = 0;
+    m_fall_elapsed  = {};
+    m_held_key      = 0;
 
     // Create initial pieces
     m_next_piece = get_random_piece();
@@ -99,18 +113,15 @@ void TetrisGame::init_game()
 
 Tetromino TetrisGame::get_random_piece()
 {
-    static std::mt19937               rng{ std::random_device{}() };
-    static std::vector<TetrominoType> bag;
-
-    if (bag.empty())
+    if (m_bag.empty())
     {
-        bag = { TetrominoType::I, TetrominoType::O, TetrominoType::T, TetrominoType::S,
-                TetrominoType::Z, TetrominoType::J, TetrominoType::L };
-        std::shuffle(bag.begin(), bag.end(), rng);
+        m_bag = { TetrominoType::I, TetrominoType::O, TetrominoType::T, TetrominoType::S,
+                  TetrominoType::Z, TetrominoType::J, TetrominoType::L };
+        std::shuffle(m_bag.begin(), m_bag.end(), m_rng);
     }
 
-    TetrominoType type = bag.back();
-    bag.pop_back();
+    TetrominoType type = m_bag.back();
+    m_bag.pop_back();
     return spawn_piece(type);
 }
 
@@ -320,9 +331,10 @@ void TetrisGame::clear_lines_and_update_score()
 
         if (full)
         {
-            // Move all rows above down
+            // Move all rows above down, the next render scrolls them on screen too
             for (int r = row; r > 0; --r)
                 m_grid[r] = m_grid[r - 1];
+            m_cleared_rows.push_back(row);
             // Clear top row
             m_grid[0].assign(GRID_WIDTH, 0);
             lines_cleared++;
@@ -370,36 +382,51 @@ void TetrisGame::spawn_new_piece()
     m_current_piece.y = 0;
 }
 
-void TetrisGame::render()
+void TetrisGame::update(GameClock::duration dt)
 {
-    if (!playback.isMusicPlaying())
-        playback.playMusic(TetrisSounds::BGM);
+    // Gravity (only if not game over and not paused)
+    if (m_game_over || m_paused)
+        return;
 
-    auto now =
-        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch())
-            .count();
+    m_fall_elapsed += dt;
+    const GameClock::duration fall_delay = std::chrono::milliseconds(get_fall_delay_ms());
+    if (m_fall_elapsed >= fall_delay)
+    {
+        if (!move_piece(0, 1))
+            merge_piece();
+        m_fall_elapsed -= fall_delay;
+    }
 
-    // Update fall timer (only if not game over and not paused)
-    if (!m_game_over && !m_paused)
+    if (m_held_key)
     {
-        if (m_last_update == 0)
+        m_repeat_in -= dt;
+        if (m_repeat_in <= GameClock::duration::zero())
         {
-            m_last_update = now;
-            m_fall_timer  = now;
+            handle_input(m_held_key);
+            m_repeat_in += REPEAT_INTERVAL;
         }
-        else
-        {
-            if (now - m_fall_timer >= static_cast<uint32_t>(get_fall_delay_ms()))
-            {
-                if (!move_piece(0, 1))
-                    merge_piece();
-                m_fall_timer = now;
-            }
-        }
-        m_last_update = now;
     }
+}
+
+void TetrisGame::render()
+{
+    if (!playback.isMusicPlaying())
+        playback.playMusic(TetrisSounds::BGM);
+
+    if (m_chrome.stale())
+    {
+        display.beginLayer(m_chrome);
+        draw_border();
+        draw_next_box();
+        draw_hud_labels();
+        display.endLayer();
+    }
+
+    // The rows above the cleared ones move down by themselves, draw_grid() then has little left to send
+    for (const int row : m_cleared_rows)
+        display.scrollRect(m_grid_x, m_grid_y, m_grid_w, (row + 1) * m_cell_size, m_cell_size);
+    m_cleared_rows.clear();
 
-    draw_border();
     draw_grid();
     draw_current_piece();
     draw_next_piece();
@@ -424,20 +451,16 @@ void TetrisGame::draw_border()
     int y2 = m_grid_y + m_grid_h;
 
     // Top border
-    for (int x = x1 + 1; x < x2; ++x)
-        display.drawPixel(x, y1, CH_BORDER_H);
+    display.drawFastHLine(x1 + 1, y1, x2 - x1 - 1, CH_BORDER_H);
 
     // Bottom border
-    for (int x = x1 + 1; x < x2; ++x)
-        display.drawPixel(x, y2, CH_BORDER_H);
+    display.drawFastHLine(x1 + 1, y2, x2 - x1 - 1, CH_BORDER_H);
 
     // Left border
-    for (int y = y1 + 1; y < y2; ++y)
-        display.drawPixel(x1, y, CH_BORDER_V);
+    display.drawFastVLine(x1, y1 + 1, y2 - y1 - 1, CH_BORDER_V);
 
     // Right border
-    for (int y = y1 + 1; y < y2; ++y)
-        display.drawPixel(x2, y, CH_BORDER_V);
+    display.drawFastVLine(x2, y1 + 1, y2 - y1 - 1, CH_BORDER_V);
 
     // Corners
     display.drawPixel(x1, y1, CH_CORNER_TL);
@@ -483,11 +506,8 @@ void TetrisGame::draw_current_piece()
     });
 }
 
-void TetrisGame::draw_next_piece()
+void TetrisGame::draw_next_box()
 {
-    const Tetromino&      piece = m_next_piece;
-    const TetrominoShape& shape = piece.shape;
-
     display.setTextColor(COLOR_HUD);
 
     int next_x = m_grid_x + m_grid_w + m_cell_size * 2;
@@ -507,20 +527,23 @@ void TetrisGame::draw_next_piece()
     int next_y2 = next_y + next_h;
 
     // Simple border
-    for (int x = next_x1 + 1; x < next_x2; ++x)
-    {
-        display.drawPixel(x, next_y1, CH_BORDER_H);
-        display.drawPixel(x, next_y2, CH_BORDER_H);
-    }
-    for (int y = next_y1 + 1; y < next_y2; ++y)
-    {
-        display.drawPixel(next_x1, y, CH_BORDER_V);
-        display.drawPixel(next_x2, y, CH_BORDER_V);
-    }
+    display.drawFastHLine(next_x1 + 1, next_y1, next_x2 - next_x1 - 1, CH_BORDER_H);
+    display.drawFastHLine(next_x1 + 1, next_y2, next_x2 - next_x1 - 1, CH_BORDER_H);
+    display.drawFastVLine(next_x1, next_y1 + 1, next_y2 - next_y1 - 1, CH_BORDER_V);
+    display.drawFastVLine(next_x2, next_y1 + 1, next_y2 - next_y1 - 1, CH_BORDER_V);
     display.drawPixel(next_x1, next_y1, CH_CORNER_TL);
     display.drawPixel(next_x2, next_y1, CH_CORNER_TR);
     display.drawPixel(next_x1, next_y2, CH_CORNER_BL);
     display.drawPixel(next_x2, next_y2, CH_CORNER_BR);
+}
+
+void TetrisGame::draw_next_piece()
+{
+    const Tetromino&      piece = m_next_piece;
+    const TetrominoShape& shape = piece.shape;
+
+    int next_x = m_grid_x + m_grid_w + m_cell_size * 2;
+    int next_y = m_grid_y + m_cell_size;
 
     // Draw the piece
     display.setTextColor(get_color_for_type(piece.type));
@@ -537,7 +560,7 @@ void TetrisGame::draw_next_piece()
     });
 }
 
-void TetrisGame::draw_hud()
+void TetrisGame::draw_hud_labels()
 {
     display.setTextColor(COLOR_HUD);
 
@@ -547,13 +570,33 @@ void TetrisGame::draw_hud()
     int hud_y = next_y + NEXT_SIZE * m_cell_size + m_cell_size * 2;
 
     display.setCursor(hud_x, hud_y);
-    display.print("Score: {}", m_score);
+    display.print("Score: ");
+
+    display.setCursor(hud_x, hud_y + 1);
+    display.print("Lines: ");
+
+    display.setCursor(hud_x, hud_y + 2);
+    display.print("Level: ");
+}
+
+void TetrisGame::draw_hud()
+{
+    display.setTextColor(COLOR_HUD);
+
+    int next_y = m_grid_y + m_cell_size;
+
+    // Right after the labels drawn by draw_hud_labels()
+    int hud_x = m_grid_x + m_grid_w + m_cell_size * 2 + 7;
+    int hud_y = next_y + NEXT_SIZE * m_cell_size + m_cell_size * 2;
+
+    display.setCursor(hud_x, hud_y);
+    display.print("{}", m_score);
 
     display.setCursor(hud_x, hud_y + 1);
-    display.print("Lines: {}", m_lines_cleared);
+    display.print("{}", m_lines_cleared);
 
     display.setCursor(hud_x, hud_y + 2);
-    display.print("Level: {}", m_level);
+    display.print("{}", m_level);
 }
 
 void TetrisGame::draw_game_over()
@@ -615,7 +658,8 @@ SceneResult TetrisGame::handle_input(uint32_t key)
 
     if (key == 'p' || key == 'P')
     {
-        m_paused = !m_paused;
+        m_paused   = !m_paused;
+        m_held_key = 0;
         if (m_paused)
             playback.pauseMusic();
         else
@@ -639,3 +683,25 @@ SceneResult TetrisGame::handle_input(uint32_t key)
 
     return ScenesGame::Tetris;
 }
+
+SceneResult TetrisGame::handle_key(uint32_t key, KeyAction action)
+{
+    const bool movement = key == TB_KEY_ARROW_LEFT || key == TB_KEY_ARROW_RIGHT || key == TB_KEY_ARROW_DOWN;
+    if (!movement || !display.keyEventsReported())
+        return Scene::handle_key(key, action);
+
+    // The terminal's repeats come too late and too slow, update() repeats the held key itself
+    switch (action)
+    {
+        case KeyAction::Repeat: return ScenesGame::Tetris;
+        case KeyAction::Release:
+            if (key == m_held_key)
+                m_held_key = 0;
+            return ScenesGame::Tetris;
+        case KeyAction::Press:
+            m_held_key  = key;
+            m_repeat_in = REPEAT_DELAY;
+            return handle_input(key);
+    }
+    return ScenesGame::Tetris;
+}
@@ -1,16 +1,11 @@
 #include "games/tictactoe.hpp"
 
-#include <thread>
+#include <algorithm>
 
 #include "settings.hpp"
 #include "terminal_display.hpp"
 
-// Tic-Tac-Toe board lines
-// These will be calculated dynamically in TTTScene constructor
-static int BOARD_SIZE     = 0;
-static int CELL_SIZE      = 0;
-static int BOARD_OFFSET_X = 0;
-static int BOARD_OFFSET_Y = 0;
+static constexpr int STRIKE_STEPS = 16;  // smoothness of the winning line animation
 
 bool TTTGame::is_board_full()
 {
@@ -19,12 +14,12 @@ bool TTTGame::is_board_full()
 
 void TTTGame::draw_piece(int row, int col, char piece)
 {
-    int x = BOARD_OFFSET_X + col * CELL_SIZE + CELL_SIZE / 4;
-    int y = BOARD_OFFSET_Y + row * CELL_SIZE + CELL_SIZE / 4;
+    int x = m_board_x + col * m_cell_size + m_cell_size / 4;
+    int y = m_board_y + row * m_cell_size + m_cell_size / 4;
 
     // draw cursor marker
-    int cx = BOARD_OFFSET_X + m_cursor_x * CELL_SIZE + CELL_SIZE / 2;
-    int cy = BOARD_OFFSET_Y + m_cursor_y * CELL_SIZE + CELL_SIZE / 2;
+    int cx = m_board_x + m_cursor_x * m_cell_size + m_cell_size / 2;
+    int cy = m_board_y + m_cursor_y * m_cell_size + m_cell_size / 2;
     display.setCursor(cx, cy);
     display.print("*");
 
@@ -32,10 +27,10 @@ void TTTGame::draw_piece(int row, int col, char piece)
     switch (piece)
     {
         case 'X':
-            display.drawLine(x, y, x + CELL_SIZE / 2, y + CELL_SIZE / 2, ' ');
-            display.drawLine(x + CELL_SIZE / 2, y, x, y + CELL_SIZE / 2, ' ');
+            display.drawLine(x, y, x + m_cell_size / 2, y + m_cell_size / 2, ' ');
+            display.drawLine(x + m_cell_size / 2, y, x, y + m_cell_size / 2, ' ');
             break;
-        case 'O': display.drawCircle(x + CELL_SIZE / 4, y + CELL_SIZE / 4, CELL_SIZE / 4, ' '); break;
+        case 'O': display.drawCircle(x + m_cell_size / 4, y + m_cell_size / 4, m_cell_size / 4, ' '); break;
     }
     display.resetColors();
 }
@@ -46,22 +41,22 @@ void TTTGame::draw_game_screen()
 
     // Vertical lines
     display.drawLine(
-        BOARD_OFFSET_X + CELL_SIZE, BOARD_OFFSET_Y, BOARD_OFFSET_X + CELL_SIZE, BOARD_OFFSET_Y + BOARD_SIZE, ' ');
+        m_board_x + m_cell_size, m_board_y, m_board_x + m_cell_size, m_board_y + m_board_size, ' ');
 
-    display.drawLine(BOARD_OFFSET_X + 2 * CELL_SIZE,
-                     BOARD_OFFSET_Y,
-                     BOARD_OFFSET_X + 2 * CELL_SIZE,
-                     BOARD_OFFSET_Y + BOARD_SIZE,
+    display.drawLine(m_board_x + 2 * m_cell_size,
+                     m_board_y,
+                     m_board_x + 2 * m_cell_size,
+                     m_board_y + m_board_size,
                      ' ');
 
     // Horizontal lines
     display.drawLine(
-        BOARD_OFFSET_X, BOARD_OFFSET_Y + CELL_SIZE, BOARD_OFFSET_X + BOARD_SIZE, BOARD_OFFSET_Y + CELL_SIZE, ' ');
+        m_board_x, m_board_y + m_cell_size, m_board_x + m_board_size, m_board_y + m_cell_size, ' ');
 
-    display.drawLine(BOARD_OFFSET_X,
-                     BOARD_OFFSET_Y + 2 * CELL_SIZE,
-                     BOARD_OFFSET_X + BOARD_SIZE,
-                     BOARD_OFFSET_Y + 2 * CELL_SIZE,
+    display.drawLine(m_board_x,
+                     m_board_y + 2 * m_cell_size,
+                     m_board_x + m_board_size,
+                     m_board_y + 2 * m_cell_size,
                      ' ');
 
     display.resetColors();
@@ -71,13 +66,13 @@ void TTTGame::draw_game_screen()
             draw_piece(r, col, c);
     });
 
-    const int cx = BOARD_OFFSET_X + m_cursor_x * CELL_SIZE + CELL_SIZE / 2;
-    const int cy = BOARD_OFFSET_Y + m_cursor_y * CELL_SIZE + CELL_SIZE / 2;
+    const int cx = m_board_x + m_cursor_x * m_cell_size + m_cell_size / 2;
+    const int cy = m_board_y + m_cursor_y * m_cell_size + m_cell_size / 2;
     display.setCursor(cx, cy);
     display.print("*");
 
     // Place player indicator in the left margin, vertically centered on the board
-    display.setCursor(BOARD_OFFSET_X / 4, BOARD_OFFSET_Y + BOARD_SIZE / 2 - 2);
+    display.setCursor(m_board_x / 4, m_board_y + m_board_size / 2 - 2);
     display.setFont(FigletType::FullWidth, "Soft");
     display.print("{}", static_cast<char>(m_current_player));
     display.resetFont();
@@ -85,20 +80,31 @@ void TTTGame::draw_game_screen()
     display.display();
 }
 
-void TTTGame::animate_line(int x0, int y0, int x1, int y1)
+void TTTGame::set_strike(int x0, int y0, int x1, int y1)
 {
-    const int steps = 16;  // smoothness
-    for (int i = 1; i <= steps; ++i)
-    {
-        int xi = x0 + (x1 - x0) * i / steps;
-        int yi = y0 + (y1 - y0) * i / steps;
-        draw_game_screen();  // redraw board and pieces
-        display.setTextBgColor(TB_WHITE);
-        display.drawLine(x0, y0, xi, yi, ' ');
-        display.display();
-        sleep_for(duration<float>(settings.game_ttt.delay_strike_anim));
-    }
+    m_strike_x0 = x0;
+    m_strike_y0 = y0;
+    m_strike_x1 = x1;
+    m_strike_y1 = y1;
+}
+
+void TTTGame::draw_strike()
+{
+    if (m_strike_step <= 0)
+        return;
+
+    // Half cells to columns/rows, for the current layout
+    const int x0 = m_board_x + m_strike_x0 * m_cell_size / 2;
+    const int y0 = m_board_y + m_strike_y0 * m_cell_size / 2;
+    const int x1 = m_board_x + m_strike_x1 * m_cell_size / 2;
+    const int y1 = m_board_y + m_strike_y1 * m_cell_size / 2;
+
+    const int xi = x0 + (x1 - x0) * m_strike_step / STRIKE_STEPS;
+    const int yi = y0 + (y1 - y0) * m_strike_step / STRIKE_STEPS;
+    display.setTextBgColor(TB_WHITE);
+    display.drawLine(x0, y0, xi, yi, ' ');
     display.resetColors();
+    display.display();
 }
 
 Player TTTGame::check_winner()
@@ -107,10 +113,7 @@ Player TTTGame::check_winner()
     for (uint8_t row = 0; row < 3; ++row)
         if (m_board[row][0] != ' ' && m_board[row][0] == m_board[row][1] && m_board[row][1] == m_board[row][2])
         {
-            animate_line(BOARD_OFFSET_X,
-                         BOARD_OFFSET_Y + row * CELL_SIZE + CELL_SIZE / 2,
-                         BOARD_OFFSET_X + BOARD_SIZE,
-                         BOARD_OFFSET_Y + row * CELL_SIZE + CELL_SIZE / 2);
+            set_strike(0, 2 * row + 1, 6, 2 * row + 1);
             return (Player)m_board[row][0];
         }
 
@@ -118,23 +121,20 @@ Player TTTGame::check_winner()
     for (uint8_t col = 0; col < 3; ++col)
         if (m_board[0][col] != ' ' && m_board[0][col] == m_board[1][col] && m_board[1][col] == m_board[2][col])
         {
-            animate_line(BOARD_OFFSET_X + col * CELL_SIZE + CELL_SIZE / 2,
-                         BOARD_OFFSET_Y,
-                         BOARD_OFFSET_X + col * CELL_SIZE + CELL_SIZE / 2,
-                         BOARD_OFFSET_Y + BOARD_SIZE);
+            set_strike(2 * col + 1, 0, 2 * col + 1, 6);
             return (Player)m_board[0][col];
         }
 
     // check diagonals
     if (m_board[0][0] != ' ' && m_board[0][0] == m_board[1][1] && m_board[1][1] == m_board[2][2])
     {
-        animate_line(BOARD_OFFSET_X, BOARD_OFFSET_Y, BOARD_OFFSET_X + BOARD_SIZE, BOARD_OFFSET_Y + BOARD_SIZE);
+        set_strike(0, 0, 6, 6);
         return (Player)m_board[0][0];
     }
 
     if (m_board[0][2] != ' ' && m_board[0][2] == m_board[1][1] && m_board[1][1] == m_board[2][0])
     {
-        animate_line(BOARD_OFFSET_X + BOARD_SIZE, BOARD_OFFSET_Y, BOARD_OFFSET_X, BOARD_OFFSET_Y + BOARD_SIZE);
+        set_strike(6, 0, 0, 6);
         return (Player)m_board[0][2];
     }
 
@@ -153,6 +153,36 @@ void TTTGame::draw_winner(Player winner)
     display.display();
 }
 
+void TTTGame::draw_board_full()
+{
+    display.setFont(FigletType::Kerning, "starwars");
+    display.centerText(display.pctY(0.50f), "Board Full");
+    display.resetFont();
+    display.display();
+}
+
+SceneTask TTTGame::show_win(Player winner)
+{
+    for (int i = 1; i <= STRIKE_STEPS; ++i)
+    {
+        m_strike_step = i;
+        co_await display_for(duration<float>(settings.game_ttt.delay_strike_anim));
+    }
+
+    m_winner     = winner;
+    m_end_screen = EndScreen::Winner;
+    co_await display_for(duration<float>(settings.game_ttt.delay_show_endgame));
+    reset_game();
+}
+
+SceneTask TTTGame::show_board_full()
+{
+    co_await display_for(500ms);
+    m_end_screen = EndScreen::BoardFull;
+    co_await display_for(duration<float>(settings.game_ttt.delay_show_endgame));
+    reset_game();
+}
+
 void TTTGame::reset_game()
 {
     display.clearDisplay();
@@ -166,74 +196,55 @@ void TTTGame::reset_game()
     m_cursor_x       = 0;
     m_old_pos_x      = 0;
     m_old_pos_y      = 0;
-    m_choose_pos     = false;
     m_current_player = Player::X;
+    m_strike_step    = 0;
+    m_winner         = Player::None;
+    m_end_screen     = EndScreen::None;
 }
 
-void TTTGame::render()
+void TTTGame::on_resize(int width, int height)
 {
-    display.clearDisplay();
-
-    {
-        // board size = 67% of the smaller terminal dimension, snapped to a multiple of 3
-        BOARD_SIZE = (std::min(display.pctX(0.67f), display.pctY(0.67f)) / 3) * 3;
-        CELL_SIZE  = BOARD_SIZE / 3;
+    // board size = 67% of the smaller terminal dimension, snapped to a multiple of 3
+    m_board_size = (std::min(static_cast<int>(width * 0.67f), static_cast<int>(height * 0.67f)) / 3) * 3;
+    m_cell_size  = m_board_size / 3;
 
-        // center horizontally, sit at 33% from top vertically
-        BOARD_OFFSET_X = (display.getWidth() - BOARD_SIZE) / 2;
-        BOARD_OFFSET_Y = display.pctY(0.1f);
-    }
+    // center horizontally, sit at 10% from top vertically
+    m_board_x = (width - m_board_size) / 2;
+    m_board_y = static_cast<int>(height * 0.1f);
+}
 
-    Player player_to_place = (m_moves % 2 == 0) ? Player::X : Player::O;
+void TTTGame::render()
+{
+    display.clearDisplay();
 
-    if (m_choose_pos)
+    switch (m_end_screen)
     {
-        if (m_board[m_cursor_y][m_cursor_x] == ' ')
-        {
-            m_board[m_cursor_y][m_cursor_x] = static_cast<char>(player_to_place);
-            m_moves++;
-            player_to_place = (m_moves % 2 == 0) ? Player::X : Player::O;
-        }
-        m_choose_pos = false;
+        case EndScreen::Winner:    draw_winner(m_winner); return;
+        case EndScreen::BoardFull: draw_board_full(); return;
+        case EndScreen::None:      break;
     }
 
-    m_current_player = player_to_place;
-
     draw_game_screen();
-
-    const Player winner = check_winner();
-    if (winner != Player::None)
-    {
-        draw_winner(winner);
-        display.display();
-        sleep_for(duration<float>(settings.game_ttt.delay_show_endgame));
-        reset_game();
-        render();
-        return;
-    }
-
-    if (is_board_full())
-    {
-        sleep_for(500ms);
-        display.clearDisplay();
-        display.setFont(FigletType::Kerning, "starwars");
-        display.centerText(display.pctY(0.50f), "Board Full");
-        display.resetFont();
-        display.display();
-        sleep_for(duration<float>(settings.game_ttt.delay_show_endgame));
-        reset_game();
-        render();
-        return;
-    }
-
+    draw_strike();
     display.display();
 }
 
 SceneResult TTTGame::handle_input(uint32_t key)
 {
+    // Only ESC gets through while the end of the game plays out
+    if (playing() && key != TB_KEY_ESC)
+        return ScenesGame::TicTacToe;
+
     switch (key)
     {
-        case TB_KEY_ESC: return Scenes::GamesMenu;
+        case TB_KEY_ESC:
+            // Left before the end played out, the game is over all the same
+            if (playing())
+            {
+                stop();
+                reset_game();
+            }
+            return Scenes::GamesMenu;
 
         case TB_KEY_ARROW_DOWN:
             if (m_cursor_y < 2)
@@ -256,8 +267,25 @@ SceneResult TTTGame::handle_input(uint32_t key)
             break;
 
         case TB_KEY_ENTER:
-        case '\n':         m_choose_pos = true; break;
+        case '\n':         place_piece(); break;
     }
 
     return ScenesGame::TicTacToe;
 }
+
+void TTTGame::place_piece()
+{
+    if (m_board[m_cursor_y][m_cursor_x] != ' ')
+        return;
+
+    m_board[m_cursor_y][m_cursor_x] = static_cast<char>(m_current_player);
+    m_moves++;
+    m_current_player = (m_moves % 2 == 0) ? Player::X : Player::O;
+
+    // The board stays as it is while the end of the game plays out
+    const Player winner = check_winner();
+    if (winner != Player::None)
+        play(show_win(winner));
+    else if (is_board_full())
+        play(show_board_full());
+}
@@ -4,9 +4,10 @@
 #include <array>
 #include <cctype>
 #include <cstdlib>
+#include <fstream>
+#include <iterator>
 #include <random>
 #include <string>
-#include <thread>
 
 #include "audio_player.hpp"
 #include "settings.hpp"
@@ -165,34 +166,53 @@ void WordleGame::draw_end_game(bool won)
     display.display();
 }
 
+SceneTask WordleGame::show_end_game(bool won)
+{
+    co_await display_for(duration<float>(settings.game_wordle.delay_show_final_grid));
+    m_end_screen = won ? EndScreen::Won : EndScreen::Lost;
+    co_await display_for(duration<float>(settings.game_wordle.delay_show_endgame));
+    reset_game();
+}
+
 std::string WordleGame::get_random_guess()
 {
-    static std::mt19937                rng{ std::random_device{}() };
     std::uniform_int_distribution<int> dist(0, m_words_list.size() - 1);
-    return str_toupper(m_words_list[dist(rng)]);
+    return str_toupper(m_words_list[dist(m_rng)]);
 }
 
 void WordleGame::reset_game()
 {
     m_buf.clear();
-    m_grid        = WordleStates{};
-    m_row         = 0;
-    m_is_correct  = false;
-    m_is_selected = false;
-    m_is_invalid  = false;
-    m_guess       = get_random_guess();
+    m_grid       = WordleStates{};
+    m_row        = 0;
+    m_is_correct = false;
+    m_is_invalid = false;
+    m_end_screen = EndScreen::None;
+    m_guess      = get_random_guess();
 }
 
-Result<> WordleGame::on_begin()
+Result<> WordleGame::on_load()
 {
-    std::ifstream f(settings.game_wordle.wordle_txt_path);
+    std::ifstream f(settings.game_wordle.wordle_txt_path, std::ios::binary);
     if (!f)
         return Err("Failed to open wordle list: " + settings.game_wordle.wordle_txt_path);
 
-    std::string word;
-    while (std::getline(f, word))
-        m_words_list.push_back(word);
+    // Read it in one go and split it, rather than a getline() per word
+    const std::string data{ std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>() };
+
+    m_words_list.clear();
+    m_words_list.reserve(data.size() / 6);  // 5 letters and a newline
+    for (size_t start = 0; start < data.size();)
+    {
+        const size_t end = std::min(data.find('\n', start), data.size());
+        m_words_list.emplace_back(data, start, end - start);
+        start = end + 1;
+    }
+    return Ok();
+}
 
+Result<> WordleGame::on_begin()
+{
     m_guess = get_random_guess();
 
     set_footer("Try to guess the word. Each letter color:\nBlack: Absent | Yellow: Present | Green: Correct");
@@ -206,85 +226,46 @@ void WordleGame::render()
 
     display.clearDisplay();
 
-    if (!m_is_selected)
+    if (m_end_screen != EndScreen::None)
     {
-        for (int c = 0; c < 5; ++c)
-        {
-            m_grid[m_row][c].ch    = c < static_cast<int>(m_buf.size()) ? m_buf[c] : ' ';
-            m_grid[m_row][c].state = TileState::Empty;
-        }
-    }
-    else
-    {
-        m_is_invalid = !is_valid(str_tolower(m_buf));
-        if (m_is_invalid)
-        {
-            m_is_selected  = false;
-            m_invalid_word = m_buf;
-        }
-        else
-        {
-            m_invalid_word.clear();
-
-            const RowStates& states = get_states(m_buf);
-            for (int c = 0; c < 5; ++c)
-            {
-                m_grid[m_row][c].ch    = m_buf[c];
-                m_grid[m_row][c].state = states[c];
-            }
-            m_row++;
-            m_is_selected = false;
-            m_buf.clear();
-
-            m_is_correct = is_correct(states);
-            if (m_is_correct)
-            {
-                draw_wordle_grid(m_grid);
-                sleep_for(duration<float>(settings.game_wordle.delay_show_final_grid));
-                display.clearDisplay();
-                draw_end_game(true);
-                sleep_for(duration<float>(settings.game_wordle.delay_show_endgame));
-                reset_game();
-                display.clearDisplay();
-            }
-        }
-    }
-
-    if (m_row == 6 && !m_is_correct)
-    {
-        draw_wordle_grid(m_grid);
-        sleep_for(duration<float>(settings.game_wordle.delay_show_final_grid));
-        display.clearDisplay();
-        draw_end_game(false);
-        sleep_for(duration<float>(settings.game_wordle.delay_show_endgame));
-        reset_game();
-        display.clearDisplay();
+        draw_end_game(m_end_screen == EndScreen::Won);
+        display.resetFont();
+        display.resetColors();
+        return;
     }
 
-    // Remaining empty rows
-    for (int r = m_row; r < 6; ++r)
-        if (m_grid[r].empty())
-            for (int c = 0; c < 5; ++c)
-                m_grid[r][c] = Tile{ ' ', TileState::Empty };
-
     draw_wordle_grid(m_grid);
     draw_not_valid(m_invalid_word);
 
     display.resetFont();
     display.resetColors();
-
-    set_footer("Try to guess the word. Each letter color:\nBlack: Absent | Yellow: Present | Green: Correct");
     display.display();
 }
 
 SceneResult WordleGame::handle_input(uint32_t key)
 {
     if (key == TB_KEY_ESC)
+    {
+        // Left before the end played out, the game is over all the same
+        if (playing())
+        {
+            stop();
+            reset_game();
+        }
         return Scenes::GamesMenu;
+    }
+
+    // No typing into the next game while this one's end plays out
+    if (playing())
+        return ScenesGame::Wordle;
 
     if (m_buf.size() == 5 && (key == TB_KEY_ENTER || key == '\n'))
-        m_is_selected = true;
-    else if (m_buf.size() < 5 && is_alpha(key))
+    {
+        submit_guess();
+        return ScenesGame::Wordle;
+    }
+
+    if (m_buf.size() < 5 && is_alpha(key))
         m_buf.push_back(toupper(key));
     else if (!m_buf.empty() && (key == TB_KEY_BACKSPACE || key == TB_KEY_BACKSPACE2))
     {
@@ -292,5 +273,34 @@ SceneResult WordleGame::handle_input(uint32_t key)
         m_is_invalid = false;
     }
 
+    // The row being typed shows the letters so far
+    for (int c = 0; c < 5; ++c)
+        m_grid[m_row][c] = Tile{ c < static_cast<int>(m_buf.size()) ? m_buf[c] : ' ', TileState::Empty };
+
     return ScenesGame::Wordle;
 }
+
+void WordleGame::submit_guess()
+{
+    m_is_invalid = !is_valid(str_tolower(m_buf));
+    if (m_is_invalid)
+    {
+        m_invalid_word = m_buf;
+        return;
+    }
+    m_invalid_word.clear();
+
+    const RowStates& states = get_states(m_buf);
+    for (int c = 0; c < 5; ++c)
+    {
+        m_grid[m_row][c].ch    = m_buf[c];
+        m_grid[m_row][c].state = states[c];
+    }
+    m_row++;
+    m_buf.clear();
+
+    // The final grid stays as it is while the end of the game plays out
+    m_is_correct = is_correct(states);
+    if (m_is_correct || m_row == 6)
+        play(show_end_game(m_is_correct));
+}
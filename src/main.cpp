@@ -25,118 +25,292 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <deque>
+#include <optional>
+#include <string_view>
+#include <vector>
 
 #include "audio_player.hpp"
-#include "games/2048.hpp"
-#include "games/snake.hpp"
-#include "games/tetris.hpp"
-#include "games/tictactoe.hpp"
-#include "games/wordle.hpp"
-#include "scenes/credits.hpp"
-#include "scenes/games_menu.hpp"
-#include "scenes/main_menu.hpp"
-#include "scenes/settings.hpp"
+#include "bench.hpp"
+#include "event_waiter.hpp"
+#include "frame_arena.hpp"
+#include "frame_governor.hpp"
+#include "frame_profiler.hpp"
+#include "game_rng.hpp"
+#include "replay.hpp"
+#include "scene_registry.hpp"
 #include "settings.hpp"
 #include "terminal_display.hpp"
 
 AudioPlayer     playback;
 TerminalDisplay display;
 Settings        settings;
+FrameArena      frame_arena;
+FrameProfiler   profiler;
+GameRng         game_rng;
 
-template <class... Ts>
-struct overloaded : Ts...
+// Most events handled before the next tick and render, when they keep coming in
+static constexpr int MAX_BATCH_EVENTS = 256;
+
+// While a scene loads: how long to just wait for it first (most loads are done by then),
+// how often to check on it after that, and after how long to say it's loading
+static constexpr std::chrono::milliseconds LOADING_GRACE{ 20 };
+static constexpr std::chrono::milliseconds LOADING_POLL{ 50 };
+static constexpr std::chrono::milliseconds LOADING_INDICATOR_DELAY{ 100 };
+static constexpr std::chrono::milliseconds LOADING_SPINNER_STEP{ 100 };
+
+// Shown while the scene the player picked is still loading
+static void render_loading(GameClock::duration waited)
 {
-    using Ts::operator()...;
-};
-template <class... Ts>
-overloaded(Ts...) -> overloaded<Ts...>;
+    static constexpr std::string_view       SPINNER = "|/-\\";
+    static const std::vector<DisplayLayer*> no_layers;
+
+    display.beginFrame();
+    display.setLayers(no_layers);
+    display.clearDisplay();
+    display.resetFont();
+    display.resetColors();
+    display.centerText(display.getHeight() / 2, "Loading {}", SPINNER[waited / LOADING_SPINNER_STEP % SPINNER.size()]);
+    display.display();
+    display.endFrame();
 
-int game_loop()
+    // Same as after a scene's frame, or the loading screen's presents pile up in the arena
+    frame_arena.reset();
+}
+
+// Runs the game till the player exits, recording the session to `record_path` if any (see InputRecorder)
+int game_loop(const char* record_path)
 {
-    MainMenuScene  main_menu;
-    GamesMenuScene games_menu;
-    CreditsScene   credits;
-    SettingsScene  settings_menu;
-
-    TetrisGame game_tetris;
-    TTTGame    game_ttt;
-    WordleGame game_wordle;
-    SnakeGame  game_snake;
-    Game2048   game_2048;
-
-    SceneResult current_scene = Scenes::MainMenu;
-    Scene*      active_scene  = nullptr;
-    bool        running       = true;
-
-    while (running)
+    SceneRegistry scenes;
+    InputRecorder recorder;
+    if (record_path && !recorder.open(record_path, game_rng.seed(), display.getWidth(), display.getHeight()))
+    {
+        display.end();
+        fprintf(stderr, "Failed to create the recording: %s\n", record_path);
+        return 1;
+    }
+
+    SceneResult           current_scene = Scenes::MainMenu;
+    SceneResult           active_id     = current_scene;
+    SceneResult           came_from     = current_scene;  // where ESC goes back to while the scene loads
+    Scene*                active_scene  = nullptr;
+    GameClock::time_point switched_at   = GameClock::now();
+    FrameGovernor         governor;
+
+    // Falls back to plain tb_peek_event() timeouts if it can't set up its timer
+    EventWaiter waiter;
+    waiter.init();
+
+    // Keys pressed while the scene was loading, it gets them first once it's going
+    std::deque<tb_event> queued;
+    const auto           take_queued = [&](tb_event& ev) {
+        if (queued.empty())
+            return false;
+        ev = queued.front();
+        queued.pop_front();
+        return true;
+    };
+
+    while (true)
     {
-        Scene* next_scene = nullptr;
+        Scene* next_scene = scenes.get(current_scene);
+        if (next_scene != active_scene)
+        {
+            if (active_scene)
+                active_scene->end(current_scene);
+            governor.reset(GameClock::now());
+            switched_at = GameClock::now();
+            came_from   = active_id;
+            active_id   = current_scene;
+        }
+
+        active_scene = next_scene;
+        if (!active_scene)
+            break;
 
-        // clang-format off
-        std::visit(overloaded{
-            [&](Scenes s) {
-                switch (s)
+        // Still loading in the background (see Scene::preload()): keep the screen alive and ESC working meanwhile
+        active_scene->preload();
+        if (!active_scene->wait_loaded(LOADING_GRACE))
+        {
+            const GameClock::duration waited = GameClock::now() - switched_at;
+            if (waited >= LOADING_INDICATOR_DELAY)
+                render_loading(waited);
+
+            tb_event ev{};
+            if (waiter.wait(ev, GameClock::now() + LOADING_POLL))
+            {
+                if (ev.type == TB_EVENT_RESIZE)
+                {
+                    display.handleResize();
+                    recorder.resize(display.getWidth(), display.getHeight());
+                }
+                else if (ev.type == TB_EVENT_KEY && ev.key == TB_KEY_ESC)
                 {
-                    case Scenes::MainMenu:     next_scene = &main_menu; break;
-                    case Scenes::GamesMenu:    next_scene = &games_menu; break;
-                    case Scenes::Credits:      next_scene = &credits; break;
-                    case Scenes::SettingsMenu: next_scene = &settings_menu; break;
-                    default:                   running = false; break;
+                    current_scene = came_from;
+                    recorder.loadCancelled();
+                    queued.clear();
                 }
-            },
-            [&](ScenesGame s) {
-                switch (s)
+                else if (ev.type == TB_EVENT_KEY)
                 {
-                    case ScenesGame::Tetris:    next_scene = &game_tetris; break;
-                    case ScenesGame::TicTacToe: next_scene = &game_ttt; break;
-                    case ScenesGame::Wordle:    next_scene = &game_wordle; break;
-                    case ScenesGame::Game2048:  next_scene = &game_2048; break;
-                    case ScenesGame::Snake:     next_scene = &game_snake; break;
-                    default:                    running = false; break;
+                    queued.push_back(ev);
                 }
             }
-        }, current_scene);
-        // clang-format on
-
-        if (active_scene && next_scene != active_scene)
-            active_scene->end(current_scene);
 
-        active_scene = next_scene;
-        if (!running || !active_scene)
-            break;
+            // The wait doesn't count as time the game owes ticks for
+            governor.reset(GameClock::now());
+            continue;
+        }
 
         // Run only once
         const Result<>& r = active_scene->begin();
         if (!r.ok())
         {
-            tb_shutdown();
+            display.end();
             fprintf(stderr, "Error while initing a scene/game: %s\n", r.error_v().c_str());
             return 1;
         }
 
-        active_scene->render_all();
+        // Get the scene the player is likely to pick next loading already
+        if (const std::optional<SceneResult> hint = active_scene->next_scene_hint())
+            if (Scene* scene = scenes.get(*hint))
+                scene->preload();
 
-        // Acquire key input
-        tb_event ev;
-        tb_peek_event(&ev, active_scene->frame_ms());
+        // Run the ticks that came due, then render if anything changed.
+        // A scene with nothing to update (paused, game over) gets no ticks, and no wake-ups for them.
+        const GameClock::duration tick  = active_scene->wants_ticks() ? milliseconds(active_scene->frame_ms()) : 0ms;
+        const int                 ticks = governor.ticksDue(GameClock::now(), tick, active_scene->max_frame_skip());
+        for (int i = 0; i < ticks; ++i)
+        {
+            active_scene->update(tick);
+            recorder.tick();
+        }
+        for (int i = 1; i < ticks; ++i)
+            display.dropFrame();
 
-        uint32_t key = 0;
-        if (ev.type == TB_EVENT_KEY)
-            key = ev.key ? ev.key : ev.ch;
+        // Carry on with the animation or sequence the scene is playing, if it's done waiting
+        if (active_scene->resume_sequence(GameClock::now()))
+        {
+            recorder.resumed();
+            governor.invalidate();
+        }
+
+        // A frame held back by the output thread goes out with the next one
+        if (display.outputPending())
+            governor.invalidate();
+
+        const GameClock::time_point now = GameClock::now();
+        if (governor.shouldRender(now))
+        {
+            governor.rendered(now);
+            active_scene->render_all();
+        }
+
+        // Acquire key input, until the next tick, render or deadline of the scene is due (blocking if none).
+        // Then take everything else already waiting in the same go, so a burst of events
+        // (auto-repeat piling up behind a slow frame, a paste, a window being dragged) costs one render, not one each
+        tb_event   ev{};
+        const bool got_event =
+            take_queued(ev) || waiter.wait(ev, governor.nextWake(GameClock::now(), tick, active_scene->deadline()));
+        governor.wokeUp(got_event);
+        if (!got_event)
+            continue;
+
+        governor.invalidate();
+
+        const SceneResult           batch_scene = current_scene;
+        bool                        resized     = false;
+        uint32_t                    last_key    = 0;
+        int                         events      = 0;
+        GameClock::duration         handle_time = 0ns;  // in the scene's handle_key(), for the profiler
+        const GameClock::time_point batch_start = GameClock::now();
+        do
+        {
+            // Relayout for the new size, once for a run of resizes, without feeding the scene a key
+            if (ev.type == TB_EVENT_RESIZE)
+            {
+                resized = true;
+                continue;
+            }
+
+            // Mouse reporting isn't turned on, nothing else is for the scene
+            if (ev.type != TB_EVENT_KEY)
+                continue;
+
+            if (resized)
+            {
+                display.handleResize();
+                active_scene->update_layout();
+                recorder.resize(display.getWidth(), display.getHeight());
+                resized = false;
+            }
 
-        current_scene = active_scene->handle_input(key);
+            // The same key again in one batch is the terminal repeating it faster than frames go by,
+            // scenes where a key means a move rather than text only want it once.
+            // If the terminal tells repeats from presses (kitty protocol), only repeats get dropped
+            const uint32_t  key      = ev.key ? ev.key : ev.ch;
+            const KeyAction action   = key_action(ev);
+            const bool      repeated = key == last_key && (display.keyEventsReported() ? action == KeyAction::Repeat
+                                                                                       : action != KeyAction::Release);
+            if (repeated && active_scene->coalesce_repeats())
+                continue;
+
+            // The profiler overlay works the same in every scene, they never see its key
+            if (key == TB_KEY_F3)
+            {
+                if (action == KeyAction::Press)
+                    profiler.toggleOverlay();
+                continue;
+            }
+
+            last_key = action == KeyAction::Release ? 0 : key;
+            recorder.key(key, action);
+
+            const GameClock::time_point handle_start = GameClock::now();
+            current_scene                            = active_scene->handle_key(key, action);
+            handle_time += GameClock::now() - handle_start;
+        } while (current_scene == batch_scene && ++events < MAX_BATCH_EVENTS &&
+                 (take_queued(ev) || display.peekEvent(ev, 0)));
+
+        profiler.record(ProfilePhase::HandleInput, handle_time);
+        profiler.record(ProfilePhase::Input, GameClock::now() - batch_start - handle_time);
+
+        if (resized)
+        {
+            display.handleResize();
+            active_scene->update_layout();
+            recorder.resize(display.getWidth(), display.getHeight());
+        }
     }
     return 0;
 }
 
 void exit()
 {
-    display.clearDisplay();
-    tb_shutdown();
+    display.end();
+    if (!profiler.dump(settings.general.profile_path))
+        fprintf(stderr, "Failed to write the frame profile to '%s'\n", settings.general.profile_path.c_str());
 }
 
-int main()
+int main(int argc, char* argv[])
 {
+    if (argc > 1 && std::string_view(argv[1]) == "--bench")
+        return run_benchmarks(argc - 2, argv + 2);
+    if (argc > 1 && std::string_view(argv[1]) == "--dump")
+        return dump_scene(argc - 2, argv + 2);
+    if (argc > 1 && std::string_view(argv[1]) == "--replay")
+        return replay_session(argc - 2, argv + 2);
+
+    // --record FILE, --seed N
+    const char* record_path = nullptr;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const std::string_view arg = argv[i];
+        if (arg == "--record")
+            record_path = argv[i + 1];
+        else if (arg == "--seed")
+            game_rng.seed(std::strtoull(argv[i + 1], nullptr, 10));
+    }
+
     if (!playback.begin())
         return -1;
 
@@ -144,5 +318,5 @@ int main()
         return 1;
 
     std::atexit(exit);
-    return game_loop();
+    return game_loop(record_path);
 }
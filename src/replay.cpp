@@ -0,0 +1,310 @@
+#include "replay.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string_view>
+
+#include "game_rng.hpp"
+#include "scene_registry.hpp"
+#include "terminal_display.hpp"
+
+// File layout: MAGIC, then varints: seed, width, height, then the entries till End.
+// Each entry is a varint of the ticks since the previous one, a kind byte and what the kind has.
+static constexpr std::string_view MAGIC = "CBRP\x01";
+
+enum ReplayEntry : uint8_t
+{
+    End,
+    Key,            // key, action
+    Resize,         // width, height
+    Resume,         //
+    LoadCancelled,  //
+    KeyEvents,      // whether the terminal reports key releases from now on
+};
+
+// -------------------------------------
+// Recording
+// -------------------------------------
+
+bool InputRecorder::open(const std::string& path, uint64_t seed, int width, int height)
+{
+    close();
+    m_file = fopen(path.c_str(), "wb");
+    if (!m_file)
+        return false;
+
+    fwrite(MAGIC.data(), 1, MAGIC.size(), m_file);
+    varint(seed);
+    varint(width);
+    varint(height);
+    m_ticks = m_last_tick = 0;
+    return true;
+}
+
+void InputRecorder::close()
+{
+    if (!m_file)
+        return;
+
+    entry(End);
+    fclose(m_file);
+    m_file = nullptr;
+}
+
+void InputRecorder::key(uint32_t key, KeyAction action)
+{
+    if (!m_file)
+        return;
+
+    // The terminal's answer comes in whenever, note it before the first key it applies to
+    if (display.keyEventsReported() != m_key_events_reported)
+    {
+        m_key_events_reported = !m_key_events_reported;
+        entry(KeyEvents);
+        varint(m_key_events_reported);
+    }
+
+    entry(Key);
+    varint(key);
+    varint(static_cast<uint64_t>(action));
+    fflush(m_file);
+}
+
+void InputRecorder::resize(int width, int height)
+{
+    if (!m_file)
+        return;
+
+    entry(Resize);
+    varint(width);
+    varint(height);
+    fflush(m_file);
+}
+
+void InputRecorder::resumed()
+{
+    if (!m_file)
+        return;
+
+    entry(Resume);
+    fflush(m_file);
+}
+
+void InputRecorder::loadCancelled()
+{
+    if (!m_file)
+        return;
+
+    entry(LoadCancelled);
+    fflush(m_file);
+}
+
+void InputRecorder::entry(uint8_t kind)
+{
+    varint(m_ticks - m_last_tick);
+    m_last_tick = m_ticks;
+    fputc(kind, m_file);
+}
+
+void InputRecorder::varint(uint64_t v)
+{
+    // LEB128: 7 bits a byte, the high bit set on all but the last
+    for (; v >= 0x80; v >>= 7)
+        fputc(static_cast<int>(v & 0x7f) | 0x80, m_file);
+    fputc(static_cast<int>(v), m_file);
+}
+
+// -------------------------------------
+// Replaying
+// -------------------------------------
+
+// Reads a recording, `ok` goes false (and stays) once it runs past the end
+struct ReplayReader
+{
+    std::string_view data;
+    size_t           pos = 0;
+    bool             ok  = true;
+
+    uint8_t byte()
+    {
+        if (pos >= data.size())
+        {
+            ok = false;
+            return End;
+        }
+        return static_cast<uint8_t>(data[pos++]);
+    }
+
+    uint64_t varint()
+    {
+        uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            const uint8_t b = byte();
+            v |= static_cast<uint64_t>(b & 0x7f) << shift;
+            if (!(b & 0x80))
+                break;
+        }
+        return v;
+    }
+};
+
+int replay_session(int argc, char* argv[])
+{
+    if (argc < 1)
+    {
+        fprintf(stderr, "usage: cliboy --replay FILE [--dump]\n");
+        return 1;
+    }
+
+    const bool dump = argc > 1 && std::string_view(argv[1]) == "--dump";
+
+    std::ifstream f(argv[0], std::ios::binary);
+    if (!f)
+    {
+        fprintf(stderr, "Failed to open the recording: %s\n", argv[0]);
+        return 1;
+    }
+    const std::string data{ std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>() };
+    if (!std::string_view(data).starts_with(MAGIC))
+    {
+        fprintf(stderr, "Not a cliboy recording: %s\n", argv[0]);
+        return 1;
+    }
+
+    ReplayReader in{ data, MAGIC.size() };
+    game_rng.seed(in.varint());
+    const int width  = static_cast<int>(in.varint());
+    const int height = static_cast<int>(in.varint());
+
+    auto             backend  = std::make_unique<HeadlessBackend>(width, height);
+    HeadlessBackend* headless = backend.get();
+    if (!in.ok || !display.begin(std::move(backend)))
+        return 1;
+
+    // The scenes take their engines from game_rng when created, so only after it got the recording's seed
+    SceneRegistry scenes;
+    SceneResult   current   = Scenes::MainMenu;
+    SceneResult   came_from = current;
+    Scene*        active    = scenes.get(current);
+    bool          started   = false;  // whether `active` got going since the switch to it
+
+    uint64_t   ticks  = 0;
+    size_t     frames = 0;
+    size_t     events = 0;
+    const auto start  = steady_clock::now();
+
+    const auto render = [&] {
+        active->render_all();
+        ++frames;
+    };
+
+    // The game loop starts a scene (and renders its first frame) once it's loaded, whatever comes next
+    const auto start_scene = [&]() -> bool {
+        if (started)
+            return true;
+
+        const Result<>& r = active->begin();
+        if (!r.ok())
+        {
+            fprintf(stderr, "Error while initing a scene/game: %s\n", r.error_v().c_str());
+            return false;
+        }
+        started = true;
+        render();
+        return true;
+    };
+
+    const auto switch_to = [&](const SceneResult& next) {
+        active->end(next);
+        came_from = current;
+        current   = next;
+        active    = scenes.get(next);
+        started   = false;
+    };
+
+    while (active)
+    {
+        const uint64_t until = ticks + in.varint();
+        const uint8_t  kind  = in.byte();
+        if (!in.ok)
+        {
+            fprintf(stderr, "The recording is cut short, replayed up to tick %llu\n",
+                    static_cast<unsigned long long>(ticks));
+            break;
+        }
+
+        if (kind == LoadCancelled)
+        {
+            switch_to(came_from);
+            continue;
+        }
+        if (!start_scene())
+            return 1;
+
+        for (; ticks < until; ++ticks)
+        {
+            if (active->frame_ms() <= 0)
+            {
+                fprintf(stderr, "Out of sync: tick %llu for a scene without ticks\n",
+                        static_cast<unsigned long long>(ticks));
+                return 1;
+            }
+            active->update(milliseconds(active->frame_ms()));
+            render();
+        }
+
+        if (kind == End)
+            break;
+
+        if (kind != KeyEvents)
+            ++events;
+        switch (kind)
+        {
+            case Key:
+            {
+                const uint32_t    key    = static_cast<uint32_t>(in.varint());
+                const KeyAction   action = static_cast<KeyAction>(in.varint());
+                const SceneResult next   = active->handle_key(key, action);
+                if (scenes.get(next) != active)
+                    switch_to(next);
+                else
+                    render();
+                break;
+            }
+            case Resize:
+            {
+                const int w = static_cast<int>(in.varint());
+                const int h = static_cast<int>(in.varint());
+                headless->resize(w, h);
+                display.handleResize();
+                active->update_layout();
+                render();
+                break;
+            }
+            case Resume:
+                active->resume_sequence(GameClock::time_point::max());
+                render();
+                break;
+            case KeyEvents:
+                headless->reportKeyEvents(in.varint() != 0);
+                break;
+            default:
+                fprintf(stderr, "Unknown entry %u in the recording\n", kind);
+                return 1;
+        }
+    }
+
+    const duration<double> elapsed = steady_clock::now() - start;
+    printf("%zu events, %llu ticks, %zu frames in %.3fs: %.0f frames/s\n", events,
+           static_cast<unsigned long long>(ticks), frames, elapsed.count(), frames / elapsed.count());
+
+    if (dump && active && started)
+    {
+        const std::string& frame = headless->dumpText();
+        fwrite(frame.data(), 1, frame.size(), stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,54 @@
+#include "scene_registry.hpp"
+
+#include <initializer_list>
+#include <variant>
+
+template <class... Ts>
+struct overloaded : Ts...
+{
+    using Ts::operator()...;
+};
+template <class... Ts>
+overloaded(Ts...) -> overloaded<Ts...>;
+
+SceneRegistry::~SceneRegistry()
+{
+    // Scenes preloaded on a hint and never entered may still be loading
+    const std::initializer_list<Scene*> all = { &m_main_menu, &m_games_menu, &m_credits, &m_settings_menu, &m_tetris,
+                                                &m_ttt,       &m_wordle,     &m_snake,   &m_2048 };
+    for (Scene* scene : all)
+        scene->wait_loaded();
+}
+
+Scene* SceneRegistry::get(const SceneResult& id)
+{
+    Scene* scene = nullptr;
+
+    // clang-format off
+    std::visit(overloaded{
+        [&](Scenes s) {
+            switch (s)
+            {
+                case Scenes::MainMenu:     scene = &m_main_menu; break;
+                case Scenes::GamesMenu:    scene = &m_games_menu; break;
+                case Scenes::Credits:      scene = &m_credits; break;
+                case Scenes::SettingsMenu: scene = &m_settings_menu; break;
+                default:                   break;
+            }
+        },
+        [&](ScenesGame s) {
+            switch (s)
+            {
+                case ScenesGame::Tetris:    scene = &m_tetris; break;
+                case ScenesGame::TicTacToe: scene = &m_ttt; break;
+                case ScenesGame::Wordle:    scene = &m_wordle; break;
+                case ScenesGame::Game2048:  scene = &m_2048; break;
+                case ScenesGame::Snake:     scene = &m_snake; break;
+                default:                    break;
+            }
+        }
+    }, id);
+    // clang-format on
+
+    return scene;
+}
@@ -12,6 +12,7 @@ enum class SettingKind
     Float,   // ←/→ = decrease/increase by a fixed step
     Bool,    // ←/→/Enter = toggle; displayed as "On" / "Off"
     String,  // Enter = opens an inline edit mode; ESC = cancels, Enter = confirms
+    Choice,  // ←/→ = previous/next option
 };
 
 struct SettingEntry
@@ -20,7 +21,7 @@ struct SettingEntry
     const char*                  label;
     SettingKind                  kind;
     std::function<std::string()> get_value;
-    std::function<void(int)>     adjust;  // Float: -1/+1; Bool: called with any n to toggle; nullptr for String
+    std::function<void(int)>     adjust;  // Float/Choice: -1/+1; Bool: called with any n to toggle; nullptr for String
     std::function<void(const std::string&)> set_str_value;  // String only; nullptr for Float/Bool
     const uint32_t*                         preview_color = nullptr;
 };
@@ -54,6 +55,23 @@ static void set_hex(uint32_t& target, const std::string& s)
         target = val;
 }
 
+static std::string fmt_color_mode(ColorMode mode)
+{
+    switch (mode)
+    {
+        case ColorMode::TrueColor: return "Truecolor";
+        case ColorMode::Colors256: return "256 colors";
+        case ColorMode::Colors16:  return "16 colors";
+        default:                   return "Auto";
+    }
+}
+
+static void cycle_color_mode(ColorMode& mode, int dir)
+{
+    constexpr int count = static_cast<int>(ColorMode::Colors16) + 1;
+    mode                = static_cast<ColorMode>((static_cast<int>(mode) + dir + count) % count);
+}
+
 static void clamp_float(float& v, float step, float lo, float hi, int dir)
 {
     v += step * dir;
@@ -82,6 +100,46 @@ static const SettingEntry entries[] = {
         nullptr,
         [](const std::string& s) { settings.general.assets_path = s; }
     },
+    {
+        nullptr,
+        "Compact terminal output",
+        SettingKind::Bool,
+        [] { return fmt_bool(settings.general.compact_output); },
+        [](int) { settings.general.compact_output = !settings.general.compact_output; },
+        nullptr
+    },
+    {
+        nullptr,
+        "Threaded terminal output",
+        SettingKind::Bool,
+        [] { return fmt_bool(settings.general.async_output); },
+        [](int) { settings.general.async_output = !settings.general.async_output; },
+        nullptr
+    },
+    {
+        nullptr,
+        "Key release events",
+        SettingKind::Bool,
+        [] { return fmt_bool(settings.general.key_events); },
+        [](int) { settings.general.key_events = !settings.general.key_events; },
+        nullptr
+    },
+    {
+        nullptr,
+        "Terminal colors",
+        SettingKind::Choice,
+        [] { return fmt_color_mode(settings.general.color_mode); },
+        [](int dir) { cycle_color_mode(settings.general.color_mode, dir); },
+        nullptr
+    },
+    {
+        nullptr,
+        "Frame profile file",
+        SettingKind::String,
+        [] { return settings.general.profile_path; },
+        nullptr,
+        [](const std::string& s) { settings.general.profile_path = s; }
+    },
 
     // Colors
     {
@@ -235,6 +293,7 @@ static void render_value(const SettingEntry& e,
     {
         case SettingKind::Float:
         case SettingKind::Bool:
+        case SettingKind::Choice:
             if (selected)
                 display.print("< {} >", val);
             else
@@ -444,6 +503,7 @@ SceneResult SettingsScene::handle_input(uint32_t key)
                 entries[m_selected_item].set_str_value(m_edit_buffer);
                 m_editing = false;
                 m_edit_buffer.clear();
+                display.refreshPalette();
                 break;
 
             case TB_KEY_BACKSPACE:
@@ -479,10 +539,12 @@ SceneResult SettingsScene::handle_input(uint32_t key)
         case TB_KEY_ARROW_RIGHT:
         {
             const SettingEntry& e = entries[m_selected_item];
-            if (e.kind == SettingKind::Float)
+            if (e.kind == SettingKind::Float || e.kind == SettingKind::Choice)
                 e.adjust(key == TB_KEY_ARROW_LEFT ? -1 : +1);
             else if (e.kind == SettingKind::Bool)
                 e.adjust(0);  // lambda just toggles, so direction irrelevant
+            display.refreshPalette();
+            display.refreshKeyEvents();
             break;
         }
 
@@ -493,6 +555,7 @@ SceneResult SettingsScene::handle_input(uint32_t key)
             if (e.kind == SettingKind::Bool)
             {
                 e.adjust(0);  // Enter also toggles bools
+                display.refreshKeyEvents();
             }
             else if (e.kind == SettingKind::String)
             {
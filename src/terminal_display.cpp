@@ -5,95 +5,407 @@
 #include <filesystem>
 #include <format>
 
-#define TB_IMPL 1
 #include "settings.hpp"
 #include "terminal_display.hpp"
-#include "utf8.h"
 
-// utf8len requires const utf8_int8_t* (aka char8_t* in C++20), but
-// std::string::c_str() returns const char*. This helper silences the
-// conversion at a single place rather than scattering casts everywhere.
+// Figlet renders kept at most, it starts over past that
+static constexpr size_t FIGLET_ART_CACHE = 32;
+
 size_t utf8_len(const std::string& s)
 {
-    return utf8len(reinterpret_cast<const utf8_int8_t*>(s.c_str()));
+    return measure_text(s).codepoints;
 }
 
-static void enable_ansi_colors()
+bool DisplayLayer::stale() const
 {
-#ifdef _WIN32
-    HANDLE hOut = GetStdHandle(STD_OUTPUT_HANDLE);
-    if (hOut == INVALID_HANDLE_VALUE)
-        return;
-
-    DWORD mode = 0;
-    if (!GetConsoleMode(hOut, &mode))
-        return;
-
-    mode |= ENABLE_VIRTUAL_TERMINAL_PROCESSING;
-    SetConsoleMode(hOut, mode);
-#endif
+    return !m_drawn || m_width != display.getWidth() || m_height != display.getHeight();
 }
 
-static uintattr_t map_color(const uintattr_t col)
+uintattr_t TerminalDisplay::mapColor(const uintattr_t col) const
 {
     // strip style flags, map the color part, reapply flags
     const uintattr_t flags = col & (TB_BOLD | TB_ITALIC | TB_UNDERLINE | TB_BLINK | TB_REVERSE | TB_DIM);
-    switch (col & ~flags)
+    const uintattr_t color = col & ~flags;
+    if (color == TB_DEFAULT)
+        return TB_DEFAULT;
+    if (color < m_palette.size())
+        return m_palette[color] | flags;
+
+    return quantize_color(color, m_backend ? m_backend->outputMode() : TB_OUTPUT_TRUECOLOR) | flags;
+}
+
+void TerminalDisplay::refreshPalette()
+{
+    if (!m_backend)
+        return;
+
+    int mode = m_backend->preferredOutputMode();
+    switch (settings.general.color_mode)
     {
-        case TB_DEFAULT: return TB_DEFAULT;
-        case TB_BLACK:   return settings.colors.black | flags;
-        case TB_RED:     return settings.colors.red | flags;
-        case TB_GREEN:   return settings.colors.green | flags;
-        case TB_YELLOW:  return settings.colors.yellow | flags;
-        case TB_BLUE:    return settings.colors.blue | flags;
-        case TB_MAGENTA: return settings.colors.magenta | flags;
-        case TB_CYAN:    return settings.colors.cyan | flags;
-        case TB_WHITE:   return settings.colors.white | flags;
-        default:         return col;
+        case ColorMode::TrueColor: mode = TB_OUTPUT_TRUECOLOR; break;
+        case ColorMode::Colors256: mode = TB_OUTPUT_256; break;
+        case ColorMode::Colors16:  mode = TB_OUTPUT_NORMAL; break;
+        default:                   break;
     }
+
+    const uint32_t colors[] = {
+        settings.colors.black, settings.colors.red,     settings.colors.green, settings.colors.yellow,
+        settings.colors.blue,  settings.colors.magenta, settings.colors.cyan,  settings.colors.white,
+    };
+
+    std::array<uintattr_t, TB_WHITE + 1> palette{};
+    palette[TB_DEFAULT] = TB_DEFAULT;
+    for (uintattr_t i = TB_BLACK; i <= TB_WHITE; ++i)
+        palette[i] = quantize_color(colors[i - TB_BLACK], mode);
+
+    if (mode == m_backend->outputMode() && palette == m_palette)
+        return;
+
+    m_backend->setOutputMode(mode);
+    m_palette = palette;
+
+    // Everything already drawn has the old colors, the layers have to be drawn again
+    for (DisplayLayer* layer : m_layers)
+        layer->invalidate();
+    m_layers_dirty = true;
+}
+
+void TerminalDisplay::refreshKeyEvents()
+{
+    if (m_backend)
+        m_backend->setKeyEvents(settings.general.key_events);
 }
 
 TerminalDisplay::~TerminalDisplay()
 {
-    clearDisplay();
-    tb_shutdown();
+    end();
 }
 
-bool TerminalDisplay::begin()
+bool TerminalDisplay::begin(std::unique_ptr<DisplayBackend> backend)
 {
-    enable_ansi_colors();
-    if (tb_init() < 0)
+    m_backend = backend ? std::move(backend) : std::make_unique<TermboxBackend>();
+    if (!m_backend->init())
         return false;
 
-    tb_set_output_mode(TB_OUTPUT_TRUECOLOR);
-
+    // Fresh backend, fresh buffers: forget whatever got drawn to the previous one,
+    // and the layers, whoever set them might be long gone
+    forgetLayers();
+    m_width  = -1;
+    m_height = -1;
+    m_palette.fill(TB_DEFAULT);
     updateDims();
-    tb_hide_cursor();
+    refreshPalette();
+    refreshKeyEvents();
     return true;
 }
 
+void TerminalDisplay::end()
+{
+    forgetLayers();
+    clearDisplay();
+    if (m_backend)
+        m_backend->shutdown();
+}
+
+void TerminalDisplay::forgetLayers()
+{
+    m_layers.clear();
+    m_target       = nullptr;
+    m_layers_dirty = true;
+}
+
+bool TerminalDisplay::ready() const
+{
+    return m_backend && m_backend->ready();
+}
+
 void TerminalDisplay::updateDims()
 {
-    m_width  = tb_width();
-    m_height = tb_height();
+    const int width  = ready() ? std::max(0, m_backend->width()) : 0;
+    const int height = ready() ? std::max(0, m_backend->height()) : 0;
+    if (width != m_width || height != m_height)
+    {
+        // The backend wiped both the screen and its front buffer on resize,
+        // so everything has to be diffed again
+        m_width  = width;
+        m_height = height;
+        m_dirty.assign(std::max(0, m_height), RowSpan{});
+        m_content.assign(std::max(0, m_height), RowSpan{ 0, m_width - 1 });
+        m_base.assign(std::max(0, m_width * m_height), blank_cell());
+        m_base_rows.assign(std::max(0, m_height), RowSpan{});
+        m_row_hash.assign(std::max(0, m_height), 0);
+        m_layers_dirty = true;
+        markAllDirty();
+    }
 
     m_cursor_x = std::clamp(m_cursor_x, 0, std::max(0, m_width - 1));
     m_cursor_y = std::clamp(m_cursor_y, 0, std::max(0, m_height - 1));
 }
 
+bool TerminalDisplay::peekEvent(tb_event& ev, int timeout_ms)
+{
+    if (m_backend)
+        m_backend->beforeInput(timeout_ms != 0);
+    return tb_peek_event(&ev, timeout_ms) == TB_OK;
+}
+
+void TerminalDisplay::handleResize()
+{
+    updateDims();
+
+    // If the size didn't change updateDims() kept the row hashes, but those rows aren't on screen anymore
+    std::fill(m_row_hash.begin(), m_row_hash.end(), 0);
+    m_layers_dirty = true;
+    markAllDirty();
+}
+
 void TerminalDisplay::clearDisplay()
 {
     updateDims();
     resetColors();
-    tb_clear();
+
+    // Only restore what got drawn since the last clear,
+    // the rest of the back buffer still matches the layers.
+    if (ready())
+    {
+        tb_cell* back = m_backend->cells();
+        for (int y = 0; y < m_height; ++y)
+        {
+            RowSpan& span = m_content[y];
+            if (span.empty())
+                continue;
+
+            const int x0 = std::max(0, span.x0);
+            const int x1 = std::min(m_width - 1, span.x1);
+            if (x0 <= x1)
+            {
+                const tb_cell* base = &m_base[y * m_width];
+                std::copy(base + x0, base + x1 + 1, back + y * m_width + x0);
+                m_dirty[y].add(x0, x1);
+            }
+            span = RowSpan{};
+        }
+
+        if (m_layers_dirty)
+            compose();
+    }
+
     m_cursor_x = 0;
     m_cursor_y = 0;
 }
 
+// Rebuild m_base from the layers, sorted by z,
+// then bring the back buffer in line with it
+void TerminalDisplay::compose()
+{
+    m_layers_dirty = false;
+    if (!ready())
+        return;
+
+    const tb_cell        blank = blank_cell();
+    std::vector<RowSpan> old_rows(m_height);
+    old_rows.swap(m_base_rows);
+    for (int y = 0; y < m_height; ++y)
+    {
+        if (old_rows[y].empty())
+            continue;
+
+        tb_cell* row = m_base.data() + y * m_width;
+        std::fill(row + old_rows[y].x0, row + old_rows[y].x1 + 1, blank);
+    }
+
+    std::vector<DisplayLayer*> layers = m_layers;
+    std::stable_sort(layers.begin(), layers.end(),
+                     [](const DisplayLayer* a, const DisplayLayer* b) { return a->z() < b->z(); });
+
+    for (const DisplayLayer* layer : layers)
+    {
+        if (layer->stale())
+            continue;
+
+        for (int y = 0; y < m_height; ++y)
+        {
+            const RowSpan& span = layer->m_rows[y];
+            if (span.empty())
+                continue;
+
+            const tb_cell* src = &layer->m_cells[y * m_width];
+            tb_cell*       dst = &m_base[y * m_width];
+            for (int x = span.x0; x <= span.x1; ++x)
+                if (src[x].ch != 0)
+                    dst[x] = src[x];
+
+            m_base_rows[y].add(span.x0, span.x1);
+        }
+    }
+
+    // Whatever got drawn this frame already stays on top
+    for (int y = 0; y < m_height; ++y)
+    {
+        RowSpan span = old_rows[y];
+        span.add(m_base_rows[y].x0, m_base_rows[y].x1);
+        span.x1 = std::min(span.x1, m_width - 1);
+        if (span.empty())
+            continue;
+
+        tb_cell* back = m_backend->cells() + y * m_width;
+        for (int x = span.x0; x <= span.x1; ++x)
+            if (!m_content[y].contains(x))
+                back[x] = m_base[y * m_width + x];
+
+        m_dirty[y].add(span.x0, span.x1);
+    }
+}
+
+void TerminalDisplay::beginLayer(DisplayLayer& layer)
+{
+    updateDims();
+    layer.m_width  = m_width;
+    layer.m_height = m_height;
+    layer.m_drawn  = false;
+    layer.m_cells.assign(std::max(0, m_width * m_height), tb_cell{});
+    layer.m_rows.assign(std::max(0, m_height), RowSpan{});
+    m_target = &layer;
+}
+
+void TerminalDisplay::endLayer()
+{
+    if (!m_target)
+        return;
+
+    m_target->m_drawn = true;
+    if (std::find(m_layers.begin(), m_layers.end(), m_target) != m_layers.end())
+        compose();
+
+    m_target = nullptr;
+}
+
+bool TerminalDisplay::setLayers(const std::vector<DisplayLayer*>& layers)
+{
+    if (layers == m_layers)
+        return false;
+
+    m_layers       = layers;
+    m_layers_dirty = true;
+    return true;
+}
+
+void TerminalDisplay::removeLayers(const std::vector<DisplayLayer*>& layers)
+{
+    for (DisplayLayer* layer : layers)
+    {
+        if (layer == m_target)
+            m_target = nullptr;
+
+        const auto it = std::find(m_layers.begin(), m_layers.end(), layer);
+        if (it == m_layers.end())
+            continue;
+
+        m_layers.erase(it);
+        m_layers_dirty = true;
+    }
+}
+
+void TerminalDisplay::markDirty(int y, int x0, int x1)
+{
+    if (y < 0 || y >= m_height || x1 < 0 || x0 >= m_width || x1 < x0)
+        return;
+
+    x0 = std::max(0, x0);
+    x1 = std::min(m_width - 1, x1);
+    m_dirty[y].add(x0, x1);
+    m_content[y].add(x0, x1);
+}
+
+void TerminalDisplay::markAllDirty()
+{
+    for (RowSpan& span : m_dirty)
+        span.add(0, m_width - 1);
+}
+
 void TerminalDisplay::display()
+{
+    if (m_frame_depth > 0)
+    {
+        m_present_pending = true;
+        return;
+    }
+
+    present();
+}
+
+void TerminalDisplay::beginFrame()
+{
+    ++m_frame_depth;
+}
+
+void TerminalDisplay::endFrame()
+{
+    if (m_frame_depth == 0 || --m_frame_depth > 0)
+        return;
+
+    present();
+}
+
+// FNV-1a over the fields of the cells, never 0 so that stays free for "unknown"
+static uint64_t hash_row(const tb_cell* row, int width)
+{
+    uint64_t hash = 0xcbf29ce484222325;
+    for (int x = 0; x < width; ++x)
+    {
+        hash = (hash ^ row[x].ch) * 0x100000001b3;
+        hash = (hash ^ row[x].fg) * 0x100000001b3;
+        hash = (hash ^ row[x].bg) * 0x100000001b3;
+    }
+    return hash ? hash : 1;
+}
+
+void TerminalDisplay::present()
 {
     updateDims();
-    tb_present();
+    m_present_pending = false;
+    if (!ready())
+        return;
+
+    DisplayStats stats;
+    stats.frames_presented = m_stats.frames_presented;
+    stats.frames_skipped   = m_stats.frames_skipped;
+    stats.frames_held      = m_stats.frames_held;
+    stats.frames_dropped   = m_stats.frames_dropped;
+    m_stats                = stats;
+
+    // Rows that hash the same as when they were last presented don't need diffing,
+    // and if none is left the whole present (and the write) can be skipped
+    const tb_cell* cells   = m_backend->cells();
+    bool           changed = false;
+    for (int y = 0; y < m_height; ++y)
+    {
+        if (m_dirty[y].empty())
+            continue;
+
+        const uint64_t hash = hash_row(cells + y * m_width, m_width);
+        if (hash == m_row_hash[y])
+        {
+            m_dirty[y] = RowSpan{};
+            continue;
+        }
+
+        m_row_hash[y] = hash;
+        changed       = true;
+    }
+
+    if (!changed && !m_backend->hasHeldChanges())
+    {
+        ++m_stats.frames_skipped;
+        return;
+    }
+
+    ++m_stats.frames_presented;
+    m_backend->present(m_dirty, m_stats);
+
+    // The backend may have found out the output is too slow for the current colors
+    if (settings.general.color_mode == ColorMode::Auto && m_backend->preferredOutputMode() != m_backend->outputMode())
+        refreshPalette();
 }
 
 void TerminalDisplay::resetColors()
@@ -104,12 +416,12 @@ void TerminalDisplay::resetColors()
 
 void TerminalDisplay::setTextColor(uintattr_t col)
 {
-    m_fg_col = map_color(col);
+    m_fg_col = mapColor(col);
 }
 
 void TerminalDisplay::setTextBgColor(uintattr_t col)
 {
-    m_bg_col = map_color(col);
+    m_bg_col = mapColor(col);
 }
 
 void TerminalDisplay::setCursor(const int x, const int y)
@@ -120,10 +432,20 @@ void TerminalDisplay::setCursor(const int x, const int y)
 
 void TerminalDisplay::setFont(FigletType figlet_type, const std::string_view font)
 {
+    m_figlet_type = figlet_type;
+
+    const auto it = std::find_if(m_fonts.begin(), m_fonts.end(), [&](const LoadedFont& loaded) {
+        return loaded.name == font && loaded.assets_path == settings.general.assets_path;
+    });
+    if (it != m_fonts.end())
+    {
+        m_flf_font = it->font;
+        return;
+    }
+
     if (!std::filesystem::exists(settings.general.assets_path))
     {
-        clearDisplay();
-        tb_shutdown();
+        end();
         fprintf(stderr, "assets path '%s' doesn't exist\n", settings.general.assets_path.c_str());
         std::exit(-1);
     }
@@ -132,32 +454,203 @@ void TerminalDisplay::setFont(FigletType figlet_type, const std::string_view fon
     m_flf_font              = flf_font::make_shared(path);
     if (!m_flf_font)
     {
-        clearDisplay();
-        tb_shutdown();
+        end();
         fprintf(stderr, "Failed to open font '%s' at path '%s'\n", font.data(), path.c_str());
         std::exit(-1);
     }
+    m_fonts.push_back({ settings.general.assets_path, std::string(font), m_flf_font });
+}
 
-    switch (figlet_type)
+void TerminalDisplay::resetFont()
+{
+    m_flf_font = nullptr;
+}
+
+// `text` in the current font. The view is valid until the next call.
+std::string_view TerminalDisplay::figletText(std::string_view text)
+{
+    for (const FigletArt& cached : m_figlet_art)
+        if (cached.font == m_flf_font.get() && cached.type == m_figlet_type && cached.text == text)
+            return cached.art;
+
+    // Text that keeps changing (a score, a timer) would grow it forever
+    if (m_figlet_art.size() >= FIGLET_ART_CACHE)
+        m_figlet_art.clear();
+
+    std::optional<figlet> fig;
+    switch (m_figlet_type)
     {
-        case FigletType::FullWidth: m_figlet.emplace(figlet(m_flf_font, full_width::make_shared())); break;
-        case FigletType::Kerning:   m_figlet.emplace(figlet(m_flf_font, kerning::make_shared())); break;
-        case FigletType::Smushed:   m_figlet.emplace(figlet(m_flf_font, smushed::make_shared())); break;
+        case FigletType::FullWidth: fig.emplace(figlet(m_flf_font, full_width::make_shared())); break;
+        case FigletType::Kerning:   fig.emplace(figlet(m_flf_font, kerning::make_shared())); break;
+        case FigletType::Smushed:   fig.emplace(figlet(m_flf_font, smushed::make_shared())); break;
     }
+
+    const std::string str(text);
+    m_figlet_art.push_back({ m_flf_font.get(), m_figlet_type, str, (*fig)(str) });
+    return m_figlet_art.back().art;
 }
 
-void TerminalDisplay::resetFont()
+void TerminalDisplay::setCell(int x, int y, uint32_t ch)
 {
-    m_flf_font = nullptr;
-    m_figlet.reset();
+    if (m_target)
+    {
+        if (x < 0 || x >= m_target->m_width || y < 0 || y >= m_target->m_height)
+            return;
+
+        tb_cell& cell = m_target->m_cells[y * m_target->m_width + x];
+        cell.ch       = ch;
+        cell.fg       = m_fg_col;
+        cell.bg       = m_bg_col;
+        m_target->m_rows[y].add(x, x);
+        return;
+    }
+
+    if (x < 0 || x >= m_width || y < 0 || y >= m_height)
+        return;
+
+    if (!ready())
+        return;
+
+    tb_cell& cell = m_backend->cells()[y * m_width + x];
+    cell.ch       = ch;
+    cell.fg       = m_fg_col;
+    cell.bg       = m_bg_col;
+    m_dirty[y].add(x, x);
+    m_content[y].add(x, x);
+}
+
+// Call `fn` on each line of `text`, split the same way std::getline() does
+template <typename Func>
+static void for_each_line(std::string_view text, Func&& fn)
+{
+    size_t pos = 0;
+    while (pos < text.size())
+    {
+        const size_t end = std::min(text.find('\n', pos), text.size());
+        fn(text.substr(pos, end - pos));
+        pos = end + 1;
+    }
+}
+
+// Same as tb_print() but through setCell(), so it also works on layers.
+// Returns the width of the text in cells, even if it couldn't be drawn.
+// Like in termbox without TB_OPT_EGC, combining characters aren't supported and get dropped.
+int TerminalDisplay::putText(int x, int y, std::string_view text)
+{
+    // tb_print() doesn't draw anything if the text starts out of bounds
+    const bool visible = x >= 0 && x < m_width && y >= 0 && y < m_height;
+
+    int    width = 0;
+    size_t i     = 0;
+    while (i < text.size())
+    {
+        int            w  = 0;
+        const uint32_t ch = utf8_next(text, i, w);
+        if (w <= 0)
+            continue;
+
+        if (visible)
+            setCell(x + width, y, ch);
+        width += w;
+    }
+    return width;
+}
+
+void TerminalDisplay::print(std::string_view text)
+{
+    const std::string_view lines = m_flf_font ? figletText(text) : text;
+
+    int max_width = 0;
+    for_each_line(lines, [&](std::string_view line) {
+        max_width = std::max(max_width, putText(m_cursor_x, m_cursor_y, line));
+        m_cursor_y++;
+    });
+
+    m_cursor_x += max_width;
+
+    if (m_cursor_x >= m_width)
+    {
+        m_cursor_x = 0;
+        m_cursor_y++;
+        if (m_cursor_y >= m_height)
+            m_cursor_y = m_height - 1;
+    }
+}
+
+void TerminalDisplay::centerText(int y, std::string_view text)
+{
+    const std::string_view lines = m_flf_font ? figletText(text) : text;
+
+    int current_y = y;
+    for_each_line(lines, [&](std::string_view line) {
+        const int x = std::max(0, (m_width - measure_text(line).cells) / 2);
+        putText(x, current_y++, line);
+        setCursor(x, current_y);
+    });
 }
 
 void TerminalDisplay::drawPixel(int x, int y, uint32_t ch)
 {
-    if (x < 0 || x >= m_width || y < 0 || y >= m_height)
+    setCell(x, y, ch);
+}
+
+// Row `y` of whatever is being drawn into (layer or back buffer), false if out of bounds
+bool TerminalDisplay::targetRow(int y, tb_cell*& row, int& width)
+{
+    if (m_target)
+    {
+        if (y < 0 || y >= m_target->m_height)
+            return false;
+
+        width = m_target->m_width;
+        row   = &m_target->m_cells[y * width];
+        return true;
+    }
+
+    if (!ready() || y < 0 || y >= m_height)
+        return false;
+
+    width = m_width;
+    row   = m_backend->cells() + y * m_width;
+    return true;
+}
+
+// Clip once, then fill the whole run of cells in one go
+void TerminalDisplay::drawFastHLine(int x, int y, int width, uint32_t ch)
+{
+    tb_cell* row   = nullptr;
+    int      row_w = 0;
+    if (width <= 0 || !targetRow(y, row, row_w))
+        return;
+
+    const int x0 = std::max(0, x);
+    const int x1 = std::min(row_w - 1, x + width - 1);
+    if (x0 > x1)
         return;
 
-    tb_set_cell(x, y, ch, m_fg_col, m_bg_col);
+    tb_cell cell{};
+    cell.ch = ch;
+    cell.fg = m_fg_col;
+    cell.bg = m_bg_col;
+    std::fill(row + x0, row + x1 + 1, cell);
+
+    if (m_target)
+    {
+        m_target->m_rows[y].add(x0, x1);
+    }
+    else
+    {
+        m_dirty[y].add(x0, x1);
+        m_content[y].add(x0, x1);
+    }
+}
+
+void TerminalDisplay::drawFastVLine(int x, int y, int height, uint32_t ch)
+{
+    const int y0 = std::max(0, y);
+    const int y1 = std::min(m_height - 1, y + height - 1);
+    for (int row = y0; row <= y1; ++row)
+        drawFastHLine(x, row, 1, ch);
 }
 
 void TerminalDisplay::drawLine(int x0, int y0, int x1, int y1, uint32_t ch)
@@ -169,6 +662,17 @@ void TerminalDisplay::drawLine(int x0, int y0, int x1, int y1, uint32_t ch)
     int sy  = (y0 < y1) ? 1 : -1;
     int err = dx - dy;
 
+    if (dy == 0)
+    {
+        drawFastHLine(std::min(x0, x1), y0, dx + 1, ch);
+        return;
+    }
+    if (dx == 0)
+    {
+        drawFastVLine(x0, std::min(y0, y1), dy + 1, ch);
+        return;
+    }
+
     while (true)
     {
         drawPixel(x0, y0, ch);
@@ -234,7 +738,54 @@ void TerminalDisplay::drawRect(int x, int y, int width, int height, uint32_t ch)
 
 void TerminalDisplay::drawFilledRect(int x, int y, int width, int height, uint32_t ch)
 {
-    for (int row = y; row < y + height; ++row)
-        for (int col = x; col < x + width; ++col)
-            drawPixel(col, row, ch);
+    const int y0 = std::max(0, y);
+    const int y1 = std::min(m_height - 1, y + height - 1);
+    for (int row = y0; row <= y1; ++row)
+        drawFastHLine(x, row, width, ch);
+}
+
+void TerminalDisplay::scrollRect(int x, int y, int width, int height, int n)
+{
+    const int target_w = m_target ? m_target->m_width : m_width;
+    const int target_h = m_target ? m_target->m_height : m_height;
+
+    const int x0 = std::max(0, x);
+    const int x1 = std::min(target_w - 1, x + width - 1);
+    const int y0 = std::max(0, y);
+    const int y1 = std::min(target_h - 1, y + height - 1);
+    if (n <= 0 || x0 > x1 || y0 > y1)
+        return;
+
+    // Bottom up, so the rows being moved aren't overwritten before they're copied
+    for (int row = y1; row >= y0 + n; --row)
+    {
+        tb_cell* dst = nullptr;
+        tb_cell* src = nullptr;
+        int      w   = 0;
+        if (!targetRow(row, dst, w) || !targetRow(row - n, src, w))
+            return;
+
+        std::copy(src + x0, src + x1 + 1, dst + x0);
+        if (m_target)
+        {
+            m_target->m_rows[row].add(x0, x1);
+        }
+        else
+        {
+            m_dirty[row].add(x0, x1);
+            m_content[row].add(x0, x1);
+        }
+    }
+    drawFilledRect(x0, y0, x1 - x0 + 1, std::min(n, y1 - y0 + 1), ' ');
+
+    // Have the terminal scroll its rows too, whatever is left to fix on them
+    // (outside the rectangle, or drawn since the last present) gets diffed as usual
+    if (!m_target && ready() && n <= y1 - y0 && m_backend->scrollRows(y0, y1, n))
+    {
+        for (int row = y0; row <= y1; ++row)
+        {
+            m_dirty[row].add(0, m_width - 1);
+            m_row_hash[row] = 0;
+        }
+    }
 }